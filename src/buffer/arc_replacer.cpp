@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ArcReplacer::ArcReplacer(size_t num_frames) : node_store_(num_frames), capacity_(num_frames) {}
+
+auto ArcReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  // T1超过目标大小p时从T1换出，否则从T2换出
+  bool from_t1 = !t1_.empty() && (t1_size_ > p_ || t2_.empty());
+  auto &list = from_t1 ? t1_ : t2_;
+  if (list.empty()) {
+    return false;
+  }
+  *frame_id = list.begin()->second;
+  EvictLocked(*frame_id);
+  return true;
+}
+
+void ArcReplacer::EvictFrame(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].list_ == ArcList::None) {
+    return;
+  }
+  if (!node_store_[frame_id].is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  EvictLocked(frame_id);
+}
+
+void ArcReplacer::EvictLocked(frame_id_t frame_id) {
+  ArcNode &node = node_store_[frame_id];
+  ListOf(node).erase(std::make_pair(node.last_access_, frame_id));
+  if (node.list_ == ArcList::T1) {
+    t1_size_--;
+    // 只被scan访问过的page不记录到B1
+    if (!node.scan_only_ && node.page_id_ != INVALID_PAGE_ID) {
+      b1_.Push(node.page_id_);
+    }
+  } else {
+    t2_size_--;
+    if (node.page_id_ != INVALID_PAGE_ID) {
+      b2_.Push(node.page_id_);
+    }
+  }
+  node = ArcNode{};
+  TrimGhosts();
+}
+
+void ArcReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size()) {
+    throw Exception("frame id is invalid");
+  }
+  ArcNode &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.list_ == ArcList::None) {
+    node.list_ = ArcList::T1;
+    node.scan_only_ = is_scan;
+    if (!is_scan && page_id != INVALID_PAGE_ID) {
+      // 在ghost list中命中，调整T1的目标大小并直接进入T2
+      if (b1_.Contains(page_id)) {
+        size_t delta = std::max<size_t>(1, b2_.Size() / b1_.Size());
+        p_ = std::min(capacity_, p_ + delta);
+        b1_.Take(page_id);
+        node.list_ = ArcList::T2;
+      } else if (b2_.Contains(page_id)) {
+        size_t delta = std::max<size_t>(1, b1_.Size() / b2_.Size());
+        p_ -= std::min(p_, delta);
+        b2_.Take(page_id);
+        node.list_ = ArcList::T2;
+      }
+    }
+    if (node.list_ == ArcList::T1) {
+      t1_size_++;
+    } else {
+      t2_size_++;
+    }
+    node.last_access_ = ++current_timestamp_;
+    node.page_id_ = page_id;
+    TrimGhosts();
+    return;
+  }
+  if (is_scan) {
+    return;
+  }
+  // 第二次访问，从T1移到T2的MRU端
+  if (node.is_evictable_) {
+    ListOf(node).erase(std::make_pair(node.last_access_, frame_id));
+  }
+  if (node.list_ == ArcList::T1) {
+    t1_size_--;
+    t2_size_++;
+    node.list_ = ArcList::T2;
+  }
+  node.scan_only_ = false;
+  node.last_access_ = ++current_timestamp_;
+  if (node.is_evictable_) {
+    ListOf(node).insert(std::make_pair(node.last_access_, frame_id));
+  }
+}
+
+void ArcReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].list_ == ArcList::None) {
+    throw Exception("frame id is invalid");
+  }
+  ArcNode &node = node_store_[frame_id];
+  if (node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    ListOf(node).insert(std::make_pair(node.last_access_, frame_id));
+  } else {
+    ListOf(node).erase(std::make_pair(node.last_access_, frame_id));
+  }
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].list_ == ArcList::None) {
+    return;
+  }
+  ArcNode &node = node_store_[frame_id];
+  if (!node.is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  ListOf(node).erase(std::make_pair(node.last_access_, frame_id));
+  if (node.list_ == ArcList::T1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  node = ArcNode{};
+}
+
+auto ArcReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return t1_.size() + t2_.size();
+}
+
+auto ArcReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // 先是T1超出目标大小p的部分，然后是T2，最后是T1剩下的部分
+  size_t t1_excess = t1_size_ > p_ ? t1_size_ - p_ : 0;
+  auto t1_it = t1_.begin();
+  for (; t1_it != t1_.end() && t1_excess > 0 && candidates.size() < max_count; ++t1_it, --t1_excess) {
+    candidates.push_back(t1_it->second);
+  }
+  for (auto it = t2_.begin(); it != t2_.end() && candidates.size() < max_count; ++it) {
+    candidates.push_back(it->second);
+  }
+  for (; t1_it != t1_.end() && candidates.size() < max_count; ++t1_it) {
+    candidates.push_back(t1_it->second);
+  }
+  return candidates;
+}
+
+auto ArcReplacer::GetTargetRecentSize() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return p_;
+}
+
+void ArcReplacer::TrimGhosts() {
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > capacity_) {
+    b1_.PopOldest();
+  }
+  while (b2_.Size() > 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.PopOldest();
+  }
+}
+
+}  // namespace bustub
@@ -12,172 +12,1375 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
+#include "common/util/string_util.h"
+#include "fmt/format.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+namespace {
+// access buffer中的entry: 最高位表示已写入，之后是page id、frame id和access type
+auto PackAccess(frame_id_t frame_id, page_id_t page_id, AccessType access_type) -> uint64_t {
+  return (uint64_t{1} << 63) | (static_cast<uint64_t>(page_id) << 32) | (static_cast<uint64_t>(frame_id) << 8) |
+         static_cast<uint64_t>(access_type);
+}
 
+/** Header of a warm-up file, followed by `count_` page ids, hottest first. */
+struct WarmUpHeader {
+  char magic_[8] = {'B', 'T', 'W', 'A', 'R', 'M', 'U', 'P'};
+  uint32_t version_ = 1;
+  uint32_t page_size_ = BUSTUB_PAGE_SIZE;
+  uint64_t count_ = 0;
+};
+}  // namespace
+
+auto BufferPriorityFromString(const std::string &name) -> std::optional<BufferPriority> {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "low") {
+    return BufferPriority::Low;
+  }
+  if (lower == "normal") {
+    return BufferPriority::Normal;
+  }
+  if (lower == "high") {
+    return BufferPriority::High;
+  }
+  return std::nullopt;
+}
+
+auto BufferPriorityToString(BufferPriority priority) -> std::string {
+  switch (priority) {
+    case BufferPriority::Low:
+      return "low";
+    case BufferPriority::Normal:
+      return "normal";
+    case BufferPriority::High:
+      return "high";
+  }
+  UNREACHABLE("unknown buffer priority");
+}
+
+BufferPoolManager::Partition::Partition(page_id_t next_page_id, size_t pool_size, size_t replacer_k,
+                                        ReplacerPolicy replacer_policy)
+    : next_page_id_(next_page_id),
+      access_buffer_(new std::atomic<uint64_t>[BPM_ACCESS_BUFFER_SIZE]) {
+  replacer_ = Replacer::Create(replacer_policy, pool_size, replacer_k);
   // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+  AddFrames(pool_size);
+  for (size_t i = 0; i < BPM_ACCESS_BUFFER_SIZE; ++i) {
+    access_buffer_[i].store(0, std::memory_order_relaxed);
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::Partition::~Partition() {
+  for (auto &chunk : chunks_) {
+    delete chunk.load();
+  }
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  frame_id_t replacement_frame;
-  if (!free_list_.empty()) {
-    // 优先从free list中获取replacement frame
-    replacement_frame = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (replacer_->Evict(&replacement_frame)) {
-      // replacer找到可以替换的frame，检查是否为dirty
-      if (pages_[replacement_frame].is_dirty_) {
-        disk_manager_->WritePage(pages_[replacement_frame].page_id_, pages_[replacement_frame].data_);
+void BufferPoolManager::Partition::AddFrames(size_t pool_size) {
+  BUSTUB_ENSURE(pool_size < (size_t{1} << 24), "too many frames in one buffer pool partition");
+  for (size_t frame = pool_size_; frame < pool_size; ++frame) {
+    auto [chunk, index] = ChunkOf(static_cast<frame_id_t>(frame));
+    if (chunks_[chunk].load(std::memory_order_relaxed) == nullptr) {
+      // 新分配一个chunk，已有的frame不会被移动
+      auto *frame_chunk = new FrameChunk(static_cast<size_t>(BPM_FRAME_CHUNK_SIZE) << chunk);
+      for (size_t i = 0; i < (static_cast<size_t>(BPM_FRAME_CHUNK_SIZE) << chunk); ++i) {
+        frame_chunk->pages_[i].frame_id_ = static_cast<frame_id_t>(frame - index + i);
+        frame_chunk->pages_[i].pin_count_.store(Page::PIN_CLAIMED, std::memory_order_relaxed);
+        frame_chunk->io_in_progress_[i].store(false, std::memory_order_relaxed);
+        // arena的内存在第一次用到时才分配
+        frame_chunk->pages_[i].data_ = frame_chunk->arena_.GetFrame(i);
       }
-      page_table_.erase(pages_[replacement_frame].page_id_);
-    } else {
-      // 没有找到
-      return nullptr;
+      chunks_[chunk].store(frame_chunk, std::memory_order_release);
+    }
+    // free list中的frame处于claimed状态，无锁路径不能pin
+    free_list_.emplace_back(static_cast<frame_id_t>(frame));
+  }
+  PageTable *table = page_table_.load(std::memory_order_relaxed);
+  if (table == nullptr || pool_size > table->MaxEntries()) {
+    // 换一个更大的page table，旧的保留到partition析构，无锁的Find可能还在读它
+    auto bigger = std::make_unique<PageTable>(pool_size);
+    if (table != nullptr) {
+      table->ForEach([&bigger](page_id_t page_id, frame_id_t frame_id) { bigger->Insert(page_id, frame_id); });
     }
+    page_table_.store(bigger.get(), std::memory_order_release);
+    page_tables_.push_back(std::move(bigger));
   }
+  pool_size_ = std::max(pool_size_, pool_size);
+  usable_size_ = pool_size_;
+}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
+                                     LogManager *log_manager, size_t num_partitions, ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      replacer_k_(replacer_k),
+      replacer_policy_(replacer_policy),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  if (bpm_compressed_cache_size > 0) {
+    compressed_cache_ = std::make_unique<CompressedPageCache>(disk_manager, bpm_compressed_cache_size);
+  }
+  BUSTUB_ENSURE(num_partitions > 0 && num_partitions <= pool_size, "invalid number of buffer pool partitions");
+  // 打开已有的db文件时，文件中已有的page id都不能再分配，free page由free page map复用
+  size_t num_pages = disk_manager_ == nullptr ? 0 : disk_manager_->GetNumPages();
+  // 把frame尽量平均地分给各个partition，每个partition的frame按chunk分配
+  for (size_t i = 0; i < num_partitions; ++i) {
+    size_t partition_size = pool_size / num_partitions + (i < pool_size % num_partitions ? 1 : 0);
+    // partition i分配的page id都和i模num_partitions同余，从不小于num_pages的第一个开始
+    auto next_page_id =
+        static_cast<page_id_t>(num_pages + (i + num_partitions - num_pages % num_partitions) % num_partitions);
+    partitions_.emplace_back(std::make_unique<Partition>(next_page_id, partition_size, replacer_k, replacer_policy));
+  }
+}
+
+BufferPoolManager::~BufferPoolManager() {
+  StopBackgroundFlusher();
+  if (!warmup_file_.empty()) {
+    DumpResidentPages(warmup_file_);
+  }
+  {
+    std::lock_guard<std::mutex> lock(prefetch_latch_);
+    stop_prefetch_ = true;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+}
+
+auto BufferPoolManager::GetFrame(size_t frame_index) -> Page * {
+  for (auto &part : partitions_) {
+    if (frame_index < part->pool_size_) {
+      return &part->GetPage(static_cast<frame_id_t>(frame_index));
+    }
+    frame_index -= part->pool_size_;
+  }
+  return nullptr;
+}
+
+auto BufferPoolManager::HugePageFrames() -> size_t {
+  size_t frames = 0;
+  for (auto &part : partitions_) {
+    for (auto &chunk : part->chunks_) {
+      auto *frame_chunk = chunk.load(std::memory_order_acquire);
+      if (frame_chunk != nullptr && frame_chunk->arena_.Backing() != FrameArenaBacking::Pages) {
+        frames += frame_chunk->arena_.NumFrames();
+      }
+    }
+  }
+  return frames;
+}
+
+void BufferPoolManager::SetReplacerPolicy(ReplacerPolicy replacer_policy) {
+  for (auto &part : partitions_) {
+    std::lock_guard<std::mutex> lock(part->latch_);
+    RebuildReplacer(*part, replacer_policy);
+  }
+  replacer_policy_ = replacer_policy;
+}
+
+void BufferPoolManager::RebuildReplacer(Partition &part, ReplacerPolicy replacer_policy) {
+  DrainAccesses(part);
+  // 新的replacer只知道当前在buffer pool中的page，之前的访问历史丢弃
+  auto replacer = Replacer::Create(replacer_policy, part.pool_size_, replacer_k_);
+  part.Table().ForEach([&part, &replacer](page_id_t page_id, frame_id_t frame_id) {
+    replacer->RecordAccess(frame_id, AccessType::Unknown, page_id);
+    // 保持和pin count中的标记一致: 正在预读的frame以及被pin住时换出失败过的frame不可换出
+    int pin_count = part.GetPage(frame_id).pin_count_.load(std::memory_order_acquire);
+    replacer->SetEvictable(frame_id, (pin_count & Page::PIN_NOT_EVICTABLE) == 0);
+  });
+  part.replacer_ = std::move(replacer);
+}
+
+auto BufferPoolManager::Resize(size_t pool_size) -> bool {
+  size_t num_partitions = partitions_.size();
+  if (pool_size < num_partitions) {
+    throw Exception(fmt::format("buffer pool size must be at least {}", num_partitions));
+  }
+  bool success = true;
+  for (size_t i = 0; i < num_partitions; ++i) {
+    auto &part = *partitions_[i];
+    size_t partition_size = pool_size / num_partitions + (i < pool_size % num_partitions ? 1 : 0);
+    std::unique_lock<std::mutex> lock(part.latch_);
+    if (partition_size > part.pool_size_) {
+      part.AddFrames(partition_size);
+      // replacer的容量跟着变大
+      RebuildReplacer(part, replacer_policy_);
+    } else if (partition_size < part.pool_size_ && !ShrinkPartition(part, lock, partition_size)) {
+      success = false;
+    }
+  }
+  size_t total = 0;
+  for (auto &part : partitions_) {
+    std::lock_guard<std::mutex> lock(part->latch_);
+    total += part->pool_size_;
+  }
+  pool_size_ = total;
+  return success;
+}
+
+auto BufferPoolManager::ShrinkPartition(Partition &part, std::unique_lock<std::mutex> &lock, size_t pool_size)
+    -> bool {
+  // 不再从free list中分出要去掉的frame
+  part.usable_size_ = pool_size;
+  auto deadline = std::chrono::steady_clock::now() + bpm_resize_timeout;
+  while (true) {
+    DrainAccesses(part);
+    std::vector<std::pair<frame_id_t, page_id_t>> writebacks;
+    bool pinned = false;
+    for (auto frame_id = static_cast<frame_id_t>(pool_size); frame_id < static_cast<frame_id_t>(part.pool_size_);
+         ++frame_id) {
+      Page &page = part.GetPage(frame_id);
+      int pin_count = 0;
+      if (page.pin_count_.load(std::memory_order_acquire) == Page::PIN_CLAIMED) {
+        // 已经在free list中
+        continue;
+      }
+      if (part.IOInProgress(frame_id) ||
+          !page.pin_count_.compare_exchange_strong(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
+        pinned = true;
+        continue;
+      }
+      // 和换出一样: dirty page先登记在writeback table中，写完之后才能从disk读
+      page_id_t page_id = page.page_id_;
+      part.replacer_->Remove(frame_id);
+      part.Table().Erase(page_id);
+      DetachFrameGroup(part, page);
+      if (page.is_dirty_) {
+        part.writeback_table_.insert(std::make_pair(page_id, frame_id));
+        part.IOInProgress(frame_id) = true;
+        writebacks.emplace_back(frame_id, page_id);
+        CountStat(StatCounter::DirtyWritebacks);
+      } else {
+        page.page_id_ = INVALID_PAGE_ID;
+        part.free_list_.push_back(frame_id);
+      }
+      CountStat(StatCounter::Evictions);
+    }
+    if (!writebacks.empty()) {
+      lock.unlock();
+      std::vector<std::future<void>> writes;
+      writes.reserve(writebacks.size());
+      for (auto &[frame_id, page_id] : writebacks) {
+        writes.push_back(disk_manager_->WritePageAsync(page_id, part.GetPage(frame_id).data_));
+      }
+      for (auto &write : writes) {
+        write.wait();
+      }
+      lock.lock();
+      for (auto &[frame_id, page_id] : writebacks) {
+        Page &page = part.GetPage(frame_id);
+        page.page_id_ = INVALID_PAGE_ID;
+        page.is_dirty_ = false;
+        FinishFrameIO(part, frame_id, page_id);
+        part.free_list_.push_back(frame_id);
+      }
+    }
+    if (!pinned) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      // 已经清空的frame留在free list中，partition保持原来的大小
+      part.usable_size_ = part.pool_size_;
+      return false;
+    }
+    // 等待pin住的frame被释放
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    lock.lock();
+  }
+  // 所有要去掉的frame都在free list中了，把它们的内存还给系统，保留frame本身给无锁路径
+  part.free_list_.remove_if(
+      [pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  for (auto frame_id = static_cast<frame_id_t>(pool_size); frame_id < static_cast<frame_id_t>(part.pool_size_);
+       ++frame_id) {
+    part.DiscardFrame(frame_id);
+  }
+  part.pool_size_ = pool_size;
+  return true;
+}
+
+auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
+  // 从轮转的起点开始，依次尝试每个partition，直到有一个能分配出frame
+  size_t num_partitions = partitions_.size();
+  size_t start = next_partition_.fetch_add(1) % num_partitions;
+  for (size_t i = 0; i < num_partitions; ++i) {
+    auto &part = *partitions_[(start + i) % num_partitions];
+    std::unique_lock<std::mutex> lock(part.latch_);
+    Page *page = NewPageInPartition(part, lock, page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto BufferPoolManager::NewPageInPartition(Partition &part, std::unique_lock<std::mutex> &lock, page_id_t *page_id)
+    -> Page * {
+  DrainAccesses(part);
+  frame_id_t replacement_frame;
+  page_id_t victim_page_id;
+  if (!AcquireFrame(part, &replacement_frame, &victim_page_id)) {
+    // 没有找到
+    CountStat(StatCounter::NoFreeFrame);
+    return nullptr;
+  }
+  CountStat(StatCounter::NewPages);
   // 创建新的page
-  page_id_t new_page_id = AllocatePage();
+  page_id_t new_page_id = AllocatePage(part);
   *page_id = new_page_id;
-  pages_[replacement_frame].page_id_ = *page_id;
-  pages_[replacement_frame].pin_count_++;
-  pages_[replacement_frame].is_dirty_ = false;
-  page_table_.insert(std::make_pair(*page_id, replacement_frame));
-  replacer_->RecordAccess(replacement_frame);
-  replacer_->SetEvictable(replacement_frame, false);
-  return &pages_[replacement_frame];
+  Page &page = part.GetPage(replacement_frame);
+  bool victim_dirty = page.is_dirty_;
+  page.is_dirty_ = false;
+  if (victim_page_id != INVALID_PAGE_ID) {
+    part.IOInProgress(replacement_frame) = true;
+  }
+  PublishFrame(part, replacement_frame, new_page_id, 1, AccessType::Unknown, true);
+  if (victim_page_id != INVALID_PAGE_ID) {
+    // 释放latch后再写回victim
+    lock.unlock();
+    EvictPage(victim_page_id, page.data_, victim_dirty);
+    lock.lock();
+    FinishFrameIO(part, replacement_frame, victim_page_id);
+  }
+  return &page;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
-  frame_id_t frame_id;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    // 已经在buffer pool中
-    frame_id = page_table_.find(page_id)->second;
-    replacer_->RecordAccess(frame_id);
-    pages_[frame_id].pin_count_++;
-    replacer_->SetEvictable(frame_id, false);
-    return &pages_[frame_id];
-  }
-
-  if (!free_list_.empty()) {
-    // 优先从free list中获取replacement frame
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (replacer_->Evict(&frame_id)) {
-      // replacer找到可以替换的frame，检查是否为dirty
-      if (pages_[frame_id].is_dirty_) {
-        disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].data_);
+auto BufferPoolManager::PopFreeFrame(Partition &part, frame_id_t *frame_id) -> bool {
+  // 缩小partition时，要去掉的frame留在free list中但不再分出去
+  auto it = std::find_if(part.free_list_.begin(), part.free_list_.end(),
+                         [&part](frame_id_t f) { return static_cast<size_t>(f) < part.usable_size_; });
+  if (it == part.free_list_.end()) {
+    return false;
+  }
+  *frame_id = *it;
+  part.free_list_.erase(it);
+  return true;
+}
+
+auto BufferPoolManager::AcquireFrame(Partition &part, frame_id_t *frame_id, page_id_t *victim_page_id) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  if (PopFreeFrame(part, frame_id)) {
+    // 优先从free list中获取replacement frame，它已经是claimed状态
+    return true;
+  }
+  while (SelectVictim(part, frame_id)) {
+    Page &victim = part.GetPage(*frame_id);
+    // pin count为0时claim这个frame，否则标记为不可换出
+    int pin_count = victim.pin_count_.load(std::memory_order_acquire);
+    bool claimed = false;
+    while (true) {
+      if (pin_count == 0) {
+        if (victim.pin_count_.compare_exchange_weak(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
+          claimed = true;
+          break;
+        }
+      } else if (victim.pin_count_.compare_exchange_weak(pin_count, pin_count | Page::PIN_NOT_EVICTABLE,
+                                                         std::memory_order_acq_rel)) {
+        break;
       }
-      page_table_.erase(pages_[frame_id].page_id_);
-    } else {
-      // 没有找到
+    }
+    if (!claimed) {
+      // 无锁路径pin住了这个frame，放回replacer，最后一个pin释放时再变成evictable
+      part.replacer_->RecordAccess(*frame_id, AccessType::Unknown, victim.page_id_);
+      part.replacer_->SetEvictable(*frame_id, false);
+      continue;
+    }
+    // replacer找到可以替换的frame，检查是否为dirty
+    CountStat(StatCounter::Evictions);
+    if (victim.is_dirty_ || compressed_cache_ != nullptr) {
+      // 写回期间别的线程不能从disk读这个page，否则会读到旧数据
+      *victim_page_id = victim.page_id_;
+      part.writeback_table_.insert(std::make_pair(victim.page_id_.load(), *frame_id));
+    }
+    part.Table().Erase(victim.page_id_);
+    DetachFrameGroup(part, victim);
+    return true;
+  }
+  return false;
+}
+
+auto BufferPoolManager::SelectVictim(Partition &part, frame_id_t *frame_id) -> bool {
+  if (!part.has_quotas_) {
+    return part.replacer_->Evict(frame_id);
+  }
+  // 当前能出现的最低rank: 默认group的page是Normal，别的group超出预留时是它的priority
+  int lowest_rank = static_cast<int>(BufferPriority::Normal);
+  for (const auto &state : part.groups_) {
+    if (state.resident_frames_ > state.reserved_frames_) {
+      lowest_rank = std::min(lowest_rank, static_cast<int>(state.priority_));
+    }
+  }
+  // 按replacer给出的顺序只看前面的一部分，选rank最低的第一个frame
+  auto candidates = part.replacer_->EvictionCandidates(BPM_QUOTA_EVICTION_PEEK);
+  if (candidates.empty()) {
+    return false;
+  }
+  int best_rank = INT_MAX;
+  for (frame_id_t candidate : candidates) {
+    int rank = EvictionRank(part, part.GetPage(candidate));
+    if (rank < best_rank) {
+      best_rank = rank;
+      *frame_id = candidate;
+      if (rank <= lowest_rank) {
+        break;
+      }
+    }
+  }
+  // 和Evict一样记录换出，ARC和2Q的ghost list才能继续调整
+  part.replacer_->EvictFrame(*frame_id);
+  return true;
+}
+
+auto BufferPoolManager::EvictionRank(Partition &part, const Page &page) -> int {
+  if (page.buffer_group_ == DEFAULT_BUFFER_GROUP) {
+    return static_cast<int>(BufferPriority::Normal);
+  }
+  auto &state = GroupOf(part, page.buffer_group_);
+  if (state.resident_frames_ <= state.reserved_frames_) {
+    // 换出之后就低于预留的数量，只有别的page都不能换出时才换出
+    return static_cast<int>(BufferPriority::High) + 1;
+  }
+  return static_cast<int>(state.priority_);
+}
+
+auto BufferPoolManager::GroupOf(Partition &part, buffer_group_t group) -> Partition::GroupState & {
+  if (group >= part.groups_.size()) {
+    part.groups_.resize(group + 1);
+  }
+  return part.groups_[group];
+}
+
+void BufferPoolManager::DetachFrameGroup(Partition &part, Page &page) {
+  if (page.buffer_group_ != DEFAULT_BUFFER_GROUP) {
+    GroupOf(part, page.buffer_group_).resident_frames_--;
+    page.buffer_group_ = DEFAULT_BUFFER_GROUP;
+  }
+}
+
+void BufferPoolManager::PublishFrame(Partition &part, frame_id_t frame_id, page_id_t page_id, int pin_count,
+                                     AccessType access_type, bool evictable) {
+  Page &page = part.GetPage(frame_id);
+  // 没有pin的乐观读可能还在读这个frame，换成别的page之前让它们验证失败
+  page.rwlatch_.InvalidateVersion();
+  page.page_id_.store(page_id, std::memory_order_relaxed);
+  part.Table().Insert(page_id, frame_id);
+  if (!part.page_groups_.empty()) {
+    auto group_it = part.page_groups_.find(page_id);
+    if (group_it != part.page_groups_.end()) {
+      page.buffer_group_ = group_it->second;
+      GroupOf(part, page.buffer_group_).resident_frames_++;
+    }
+  }
+  part.replacer_->RecordAccess(frame_id, access_type, page_id);
+  part.replacer_->SetEvictable(frame_id, evictable);
+  // 最后写pin count，之后无锁路径才能pin这个frame
+  page.pin_count_.store(pin_count | (evictable ? 0 : Page::PIN_NOT_EVICTABLE), std::memory_order_release);
+}
+
+void BufferPoolManager::EvictPage(page_id_t page_id, const char *page_data, bool is_dirty) {
+  if (compressed_cache_ != nullptr) {
+    // 干净的page也放进压缩缓存，dirty page由压缩缓存负责写回
+    compressed_cache_->Put(page_id, page_data, is_dirty);
+    return;
+  }
+  if (is_dirty) {
+    disk_manager_->WritePage(page_id, page_data);
+    CountStat(StatCounter::DirtyWritebacks);
+  }
+}
+
+void BufferPoolManager::ReadPageData(page_id_t page_id, Page *page) {
+  bool is_dirty = false;
+  if (compressed_cache_ != nullptr && compressed_cache_->Take(page_id, page->data_, &is_dirty)) {
+    // 压缩缓存中的dirty page还没有写回disk，回到buffer pool之后仍然是dirty
+    if (is_dirty) {
+      page->is_dirty_ = true;
+    }
+    return;
+  }
+  disk_manager_->ReadPage(page_id, page->data_);
+}
+
+void BufferPoolManager::WaitForFrameIO(Partition &part, std::unique_lock<std::mutex> &lock, frame_id_t frame_id) {
+  if (!part.IOInProgress(frame_id)) {
+    return;
+  }
+  // 只统计真正阻塞的等待
+  CountStat(StatCounter::IOWaits);
+  ScopedLatency<Stats> timer(&stats_, static_cast<size_t>(StatHistogram::IOWaitLatency));
+  part.IODone(frame_id).wait(lock, [&part, frame_id] { return !part.IOInProgress(frame_id); });
+}
+
+void BufferPoolManager::FinishFrameIO(Partition &part, frame_id_t frame_id, page_id_t victim_page_id) {
+  if (victim_page_id != INVALID_PAGE_ID) {
+    part.writeback_table_.erase(victim_page_id);
+  }
+  part.IOInProgress(frame_id).store(false, std::memory_order_release);
+  part.IODone(frame_id).notify_all();
+}
+
+auto BufferPoolManager::TryPinFast(Partition &part, page_id_t page_id, AccessType access_type) -> Page * {
+  frame_id_t frame_id;
+  if (!part.Table().Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  Page &page = part.GetPage(frame_id);
+  int pin_count = page.pin_count_.load(std::memory_order_acquire);
+  do {
+    if ((pin_count & Page::PIN_CLAIMED) != 0) {
       return nullptr;
     }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acq_rel));
+  // pin住之后frame不会被重新分配，再确认它还是这个page，并且没有正在进行的I/O
+  if (page.page_id_.load(std::memory_order_acquire) != page_id ||
+      part.IOInProgress(frame_id).load(std::memory_order_acquire)) {
+    ReleasePin(part, frame_id);
+    return nullptr;
   }
-  // 从disk中读区数据
-  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_++;
-  pages_[frame_id].is_dirty_ = false;
-  page_table_.insert(std::make_pair(page_id, frame_id));
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  return &pages_[frame_id];
+  RecordAccessDeferred(part, frame_id, page_id, access_type);
+  CountStat(StatCounter::Hits);
+  return &page;
+}
+
+void BufferPoolManager::ReleasePin(Partition &part, frame_id_t frame_id) {
+  Page &page = part.GetPage(frame_id);
+  int pin_count = page.pin_count_.load(std::memory_order_acquire);
+  while ((pin_count & Page::PIN_COUNT_MASK) > 1 || (pin_count & Page::PIN_NOT_EVICTABLE) == 0) {
+    if (page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+  // 最后一个pin，并且replacer认为这个frame不可换出，需要持有latch
+  std::lock_guard<std::mutex> lock(part.latch_);
+  ReleasePinLocked(part, frame_id);
+}
+
+void BufferPoolManager::ReleasePinLocked(Partition &part, frame_id_t frame_id) {
+  Page &page = part.GetPage(frame_id);
+  int pin_count = page.pin_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  if (pin_count == Page::PIN_NOT_EVICTABLE && !part.pending_deletes_.empty() && !part.IOInProgress(frame_id)) {
+    // 等待删除的page释放了最后一个pin，claim失败说明无锁路径又pin住了它，等下一次释放
+    page_id_t page_id = page.page_id_.load(std::memory_order_relaxed);
+    if (part.pending_deletes_.count(page_id) != 0 &&
+        page.pin_count_.compare_exchange_strong(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
+      part.replacer_->SetEvictable(frame_id, true);
+      FreeFrame(part, frame_id, page_id);
+      return;
+    }
+  }
+  if ((pin_count & Page::PIN_COUNT_MASK) == 0 && (pin_count & Page::PIN_NOT_EVICTABLE) != 0 &&
+      !part.IOInProgress(frame_id)) {
+    page.pin_count_.fetch_and(~Page::PIN_NOT_EVICTABLE, std::memory_order_acq_rel);
+    part.replacer_->SetEvictable(frame_id, true);
+  }
+}
+
+void BufferPoolManager::RecordAccessDeferred(Partition &part, frame_id_t frame_id, page_id_t page_id,
+                                             AccessType access_type) {
+  uint64_t tail = part.access_tail_.load(std::memory_order_relaxed);
+  while (true) {
+    if (tail - part.access_head_.load(std::memory_order_acquire) >= BPM_ACCESS_BUFFER_SIZE) {
+      // 缓冲区满了: 能拿到latch就顺便清空，拿不到就丢弃这次访问记录，replacer只是少看到一次访问
+      std::unique_lock<std::mutex> lock(part.latch_, std::try_to_lock);
+      if (lock.owns_lock()) {
+        DrainAccesses(part);
+        part.replacer_->RecordAccess(frame_id, access_type, page_id);
+      }
+      return;
+    }
+    if (part.access_tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  part.access_buffer_[tail & (BPM_ACCESS_BUFFER_SIZE - 1)].store(PackAccess(frame_id, page_id, access_type),
+                                                                  std::memory_order_release);
+}
+
+void BufferPoolManager::DrainAccesses(Partition &part) {
+  uint64_t head = part.access_head_.load(std::memory_order_relaxed);
+  uint64_t tail = part.access_tail_.load(std::memory_order_acquire);
+  for (; head < tail; head++) {
+    uint64_t entry = part.access_buffer_[head & (BPM_ACCESS_BUFFER_SIZE - 1)].exchange(0, std::memory_order_acquire);
+    if (entry == 0) {
+      // 这个位置还没有写完，下次再处理
+      break;
+    }
+    auto page_id = static_cast<page_id_t>((entry >> 32) & INT32_MAX);
+    auto frame_id = static_cast<frame_id_t>((entry >> 8) & 0xFFFFFF);
+    auto access_type = static_cast<AccessType>(entry & 0xFF);
+    // frame可能已经被换出，只记录仍然有效的访问
+    frame_id_t mapped_frame_id;
+    if (part.Table().Find(page_id, &mapped_frame_id) && mapped_frame_id == frame_id) {
+      part.replacer_->RecordAccess(frame_id, access_type, page_id);
+    }
+  }
+  part.access_head_.store(head, std::memory_order_release);
+}
+
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  auto &part = GetPartition(page_id);
+  if (Page *page = TryPinFast(part, page_id, access_type); page != nullptr) {
+    return page;
+  }
+  std::unique_lock<std::mutex> lock(part.latch_);
+  DrainAccesses(part);
+  while (true) {
+    frame_id_t frame_id;
+    if (part.Table().Find(page_id, &frame_id)) {
+      // 已经在buffer pool中
+      part.replacer_->RecordAccess(frame_id, access_type, page_id);
+      part.GetPage(frame_id).pin_count_.fetch_add(1, std::memory_order_acq_rel);
+      CountStat(StatCounter::Hits);
+      // 如果别的线程正在从disk读这个page，只等待这一个frame
+      WaitForFrameIO(part, lock, frame_id);
+      return &part.GetPage(frame_id);
+    }
+    auto wb_it = part.writeback_table_.find(page_id);
+    if (wb_it == part.writeback_table_.end()) {
+      break;
+    }
+    // 这个page刚被换出，还在写回disk，写完之后再重新查找
+    WaitForFrameIO(part, lock, wb_it->second);
+  }
+
+  frame_id_t frame_id;
+  page_id_t victim_page_id;
+  if (!AcquireFrame(part, &frame_id, &victim_page_id)) {
+    // 没有找到
+    CountStat(StatCounter::NoFreeFrame);
+    return nullptr;
+  }
+  CountStat(StatCounter::Misses);
+  ScopedLatency<Stats> timer(&stats_, static_cast<size_t>(StatHistogram::MissLatency));
+  Page &page = part.GetPage(frame_id);
+  bool victim_dirty = page.is_dirty_;
+  page.is_dirty_ = false;
+  part.IOInProgress(frame_id) = true;
+  PublishFrame(part, frame_id, page_id, 1, access_type, true);
+  lock.unlock();
+
+  // 不持有latch，写回victim并读取数据
+  if (victim_page_id != INVALID_PAGE_ID) {
+    EvictPage(victim_page_id, page.data_, victim_dirty);
+  }
+  ReadPageData(page_id, &page);
+
+  lock.lock();
+  FinishFrameIO(part, frame_id, victim_page_id);
+  return &page;
 }
 
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
+  auto &part = GetPartition(page_id);
+  frame_id_t frame_id;
+  // 调用者持有pin的时候frame不会被重新分配，不需要latch
+  if (part.Table().Find(page_id, &frame_id) &&
+      part.GetPage(frame_id).page_id_.load(std::memory_order_acquire) == page_id) {
+    return ReleasePage(&part.GetPage(frame_id), is_dirty);
+  }
+  std::lock_guard<std::mutex> lock(part.latch_);
+  if (!part.Table().Find(page_id, &frame_id)) {
     // 没找到这个page
     return false;
   }
-  frame_id_t frame_id = page_table_.find(page_id)->second;
-  if (pages_[frame_id].GetPinCount() <= 0) {
+  Page &page = part.GetPage(frame_id);
+  if (page.GetPinCount() <= 0) {
     // 已经unpin状态，不需要操作
     return false;
   }
-  pages_[frame_id].pin_count_--;
-  if (pages_[frame_id].pin_count_ == 0) {
-    replacer_->SetEvictable(frame_id, true);
+  if (is_dirty) {
+    page.is_dirty_ = true;
   }
-  if (!pages_[frame_id].is_dirty_ && is_dirty) {
-    pages_[frame_id].is_dirty_ = is_dirty;
+  ReleasePinLocked(part, frame_id);
+  return true;
+}
+
+auto BufferPoolManager::ReleasePage(Page *page, bool is_dirty) -> bool {
+  auto &part = GetPartition(page->page_id_.load(std::memory_order_acquire));
+  frame_id_t frame_id = page->frame_id_;
+  int pin_count = page->pin_count_.load(std::memory_order_acquire);
+  if ((pin_count & Page::PIN_CLAIMED) != 0 || (pin_count & Page::PIN_COUNT_MASK) == 0) {
+    // 已经unpin状态，不需要操作
+    return false;
+  }
+  // dirty标记要在释放pin之前写入，换出这个frame的线程才能看到
+  if (is_dirty) {
+    page->is_dirty_.store(true, std::memory_order_relaxed);
   }
+  ReleasePin(part, frame_id);
   return true;
 }
 
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
+  auto &part = GetPartition(page_id);
+  std::unique_lock<std::mutex> lock(part.latch_);
+  frame_id_t frame_id;
+  bool found = part.Table().Find(page_id, &frame_id);
+  while (found && part.IOInProgress(frame_id)) {
+    WaitForFrameIO(part, lock, frame_id);
+    found = part.Table().Find(page_id, &frame_id);
+  }
+  if (!found) {
     // 没找到这个page
     return false;
   }
-  frame_id_t frame_id = page_table_.find(page_id)->second;
-  disk_manager_->WritePage(page_id, pages_[frame_id].data_);
-  pages_[frame_id].is_dirty_ = false;
+  // 写disk期间临时pin住这个frame，防止被换出
+  Page &page = part.GetPage(frame_id);
+  page.pin_count_.fetch_add(1, std::memory_order_acq_rel);
+  // 先清除dirty，这样写disk期间的修改不会丢失
+  page.is_dirty_ = false;
+  lock.unlock();
+
+  // 持有page的读锁，避免写出修改了一半的数据
+  page.RLatch();
+  disk_manager_->WritePage(page_id, page.data_);
+  page.RUnlatch();
+
+  lock.lock();
+  ReleasePinLocked(part, frame_id);
   return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-  // 使用迭代器遍历 map
-  for (auto &it : page_table_) {
-    page_id_t page_id = it.first;
-    FlushPage(page_id);
+  struct DirtyFrame {
+    Partition *part_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+  // 先收集所有dirty page，写disk期间临时pin住
+  std::vector<DirtyFrame> frames;
+  for (auto &part : partitions_) {
+    std::lock_guard<std::mutex> lock(part->latch_);
+    part->Table().ForEach([&part, &frames](page_id_t page_id, frame_id_t frame_id) {
+      Page &page = part->GetPage(frame_id);
+      if (!page.is_dirty_ || part->IOInProgress(frame_id)) {
+        return;
+      }
+      page.pin_count_.fetch_add(1, std::memory_order_acq_rel);
+      page.is_dirty_ = false;
+      frames.push_back({part.get(), frame_id, page_id});
+    });
+  }
+
+  // 按page id排序，连续的page合并成一次vectored write
+  std::sort(frames.begin(), frames.end(),
+            [](const DirtyFrame &a, const DirtyFrame &b) { return a.page_id_ < b.page_id_; });
+  // 每个page在读锁下复制出来再写，同一时间只持有一个page的读锁，不会和按树的顺序加写锁的线程死锁
+  std::vector<std::future<void>> writes;
+  std::vector<std::unique_ptr<char, decltype(&std::free)>> buffers;
+  size_t buffered_pages = 0;
+  size_t run_start = 0;
+  while (run_start < frames.size()) {
+    size_t run_end = run_start + 1;
+    while (run_end < frames.size() && frames[run_end].page_id_ == frames[run_end - 1].page_id_ + 1) {
+      run_end++;
+    }
+    // 按page对齐，direct I/O不需要再复制一次
+    size_t run_bytes = (run_end - run_start) * BUSTUB_PAGE_SIZE;
+    std::unique_ptr<char, decltype(&std::free)> buffer(
+        static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, run_bytes)), &std::free);
+    std::vector<const char *> run;
+    run.reserve(run_end - run_start);
+    for (size_t i = run_start; i < run_end; i++) {
+      Page &page = frames[i].part_->GetPage(frames[i].frame_id_);
+      char *data = buffer.get() + (i - run_start) * BUSTUB_PAGE_SIZE;
+      page.RLatch();
+      memcpy(data, page.data_, BUSTUB_PAGE_SIZE);
+      page.RUnlatch();
+      run.push_back(data);
+    }
+    writes.push_back(disk_manager_->WritePagesAsync(frames[run_start].page_id_, run));
+    buffers.push_back(std::move(buffer));
+    buffered_pages += run_end - run_start;
+    if (buffered_pages >= static_cast<size_t>(BPM_FLUSH_BATCH_PAGES)) {
+      // 限制复制出来的page占用的内存
+      for (auto &write : writes) {
+        write.wait();
+      }
+      writes.clear();
+      buffers.clear();
+      buffered_pages = 0;
+    }
+    run_start = run_end;
+  }
+  for (auto &write : writes) {
+    write.wait();
   }
+
+  for (auto &frame : frames) {
+    std::lock_guard<std::mutex> lock(frame.part_->latch_);
+    ReleasePinLocked(*frame.part_, frame.frame_id_);
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Flush();
+  }
+  // 相当于一次checkpoint，所有page写完之后只sync一次
+  disk_manager_->Sync();
 }
 
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
-    // 没找到这个page
+  auto &part = GetPartition(page_id);
+  std::unique_lock<std::mutex> lock(part.latch_);
+  frame_id_t frame_id;
+  if (!FindFrameForDelete(part, lock, page_id, &frame_id)) {
+    // 没找到这个page，disk上的page也可以释放
+    DeallocatePage(part, page_id);
     return true;
   }
-  frame_id_t frame_id = page_table_.find(page_id)->second;
-  if (pages_[frame_id].pin_count_ > 0) {
+  Page &page = part.GetPage(frame_id);
+  int pin_count = 0;
+  if (!page.pin_count_.compare_exchange_strong(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
     // pin cannot be deleted
     return false;
   }
-  replacer_->Remove(frame_id);
-  page_table_.erase(page_id);
-  free_list_.emplace_back(static_cast<int>(frame_id));
-  DeallocatePage(page_id);
+  FreeFrame(part, frame_id, page_id);
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManager::DeferDeletePage(page_id_t page_id) {
+  auto &part = GetPartition(page_id);
+  std::unique_lock<std::mutex> lock(part.latch_);
+  frame_id_t frame_id;
+  if (!FindFrameForDelete(part, lock, page_id, &frame_id)) {
+    DeallocatePage(part, page_id);
+    return;
+  }
+  // 还有pin就标记为不可换出，最后一个pin只能在latch下释放，由ReleasePinLocked完成删除
+  Page &page = part.GetPage(frame_id);
+  int pin_count = page.pin_count_.load(std::memory_order_acquire);
+  while (true) {
+    if ((pin_count & Page::PIN_COUNT_MASK) == 0) {
+      if (page.pin_count_.compare_exchange_weak(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
+        break;
+      }
+    } else if (page.pin_count_.compare_exchange_weak(pin_count, pin_count | Page::PIN_NOT_EVICTABLE,
+                                                     std::memory_order_acq_rel)) {
+      part.replacer_->SetEvictable(frame_id, false);
+      part.pending_deletes_.insert(page_id);
+      return;
+    }
+  }
+  if ((pin_count & Page::PIN_NOT_EVICTABLE) != 0) {
+    part.replacer_->SetEvictable(frame_id, true);
+  }
+  FreeFrame(part, frame_id, page_id);
+}
+
+auto BufferPoolManager::FindFrameForDelete(Partition &part, std::unique_lock<std::mutex> &lock, page_id_t page_id,
+                                           frame_id_t *frame_id) -> bool {
+  bool found = part.Table().Find(page_id, frame_id);
+  while (true) {
+    if (found && part.IOInProgress(*frame_id)) {
+      // 等待预读完成
+      WaitForFrameIO(part, lock, *frame_id);
+    } else if (auto wb_it = part.writeback_table_.find(page_id); wb_it != part.writeback_table_.end()) {
+      // 等待写回完成，否则page id被重新分配之后旧的数据可能覆盖新的数据
+      WaitForFrameIO(part, lock, wb_it->second);
+    } else {
+      return found;
+    }
+    found = part.Table().Find(page_id, frame_id);
+  }
+}
+
+void BufferPoolManager::FreeFrame(Partition &part, frame_id_t frame_id, page_id_t page_id) {
+  Page &page = part.GetPage(frame_id);
+  part.pending_deletes_.erase(page_id);
+  part.replacer_->Remove(frame_id);
+  part.Table().Erase(page_id);
+  DetachFrameGroup(part, page);
+  page.page_id_ = INVALID_PAGE_ID;
+  page.is_dirty_ = false;
+  part.free_list_.emplace_back(static_cast<int>(frame_id));
+  DeallocatePage(part, page_id);
+}
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+auto BufferPoolManager::AllocatePage(Partition &part) -> page_id_t {
+  // 每个partition只分配属于自己的page id: partition_id, partition_id + n, partition_id + 2n, ...
+  // 优先复用最小的free page，让db文件保持紧凑
+  auto stride = partitions_.size();
+  page_id_t page_id = disk_manager_->AllocateFreePage(part.next_page_id_, stride, part.next_page_id_ % stride);
+  if (page_id != INVALID_PAGE_ID) {
+    return page_id;
+  }
+  page_id = part.next_page_id_;
+  part.next_page_id_ += static_cast<page_id_t>(stride);
+  disk_manager_->ClaimPage(page_id);
+  return page_id;
+}
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  Page *page = FetchPage(page_id);
+void BufferPoolManager::DeallocatePage(Partition &part, page_id_t page_id) {
+  part.page_groups_.erase(page_id);
+  // 压缩缓存中的旧数据不能再写回disk
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  // 只释放分配过的page
+  if (page_id != INVALID_PAGE_ID && page_id < part.next_page_id_) {
+    disk_manager_->DeallocatePage(page_id);
+  }
+}
+
+void BufferPoolManager::StartBackgroundFlusher() {
+  if (enable_background_flusher_.exchange(true)) {
+    return;
+  }
+  background_flusher_thread_ = std::thread(&BufferPoolManager::RunBackgroundFlusher, this);
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+  if (!enable_background_flusher_.exchange(false)) {
+    return;
+  }
+  background_flusher_thread_.join();
+}
+
+void BufferPoolManager::RunBackgroundFlusher() {
+  auto last_warmup_dump = std::chrono::steady_clock::now();
+  while (enable_background_flusher_) {
+    std::this_thread::sleep_for(bpm_flusher_interval);
+    size_t flushed = 0;
+    for (auto &part : partitions_) {
+      flushed += CleanPartition(*part);
+    }
+    if (flushed > 0) {
+      disk_manager_->SyncBatch();
+    }
+    // 定期保存warm-up文件，进程崩溃之后也能预热
+    if (!warmup_file_.empty() && std::chrono::steady_clock::now() - last_warmup_dump >= bpm_warmup_dump_interval) {
+      DumpResidentPages(warmup_file_);
+      last_warmup_dump = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+auto BufferPoolManager::CleanPartition(Partition &part) -> size_t {
+  std::unique_lock<std::mutex> lock(part.latch_);
+  // 可以不写disk直接复用的frame: free list中的frame和干净的unpinned frame
+  DrainAccesses(part);
+  auto candidates = part.replacer_->EvictionCandidates(part.pool_size_);
+  size_t reusable = part.free_list_.size();
+  for (auto frame_id : candidates) {
+    // 无锁路径pin住的frame也可能在replacer中
+    if (!part.GetPage(frame_id).is_dirty_ && part.GetPage(frame_id).GetPinCount() == 0) {
+      reusable++;
+    }
+  }
+  if (reusable >= bpm_flusher_low_watermark * part.pool_size_) {
+    return 0;
+  }
+  auto target = static_cast<size_t>(bpm_flusher_high_watermark * part.pool_size_);
+  bool check_wal = enable_logging && log_manager_ != nullptr;
+
+  // 按照换出的顺序选择dirty frame，写disk期间临时pin住
+  std::vector<frame_id_t> frames;
+  for (auto frame_id : candidates) {
+    if (reusable + frames.size() >= target || frames.size() >= bpm_flusher_max_pages) {
+      break;
+    }
+    Page &page = part.GetPage(frame_id);
+    if (!page.is_dirty_ || page.GetPinCount() > 0 || part.IOInProgress(frame_id)) {
+      continue;
+    }
+    if (check_wal && page.GetLSN() > log_manager_->GetPersistentLSN()) {
+      // WAL: 日志还没有持久化之前不能写回这个page
+      continue;
+    }
+    page.pin_count_.fetch_add(1, std::memory_order_acq_rel);
+    page.is_dirty_ = false;
+    frames.push_back(frame_id);
+  }
+  lock.unlock();
+
+  // 和FlushAllPages一样，每个page在自己的读锁下复制出来再写，同一时间只持有一个page的读锁。
+  // pin一直保留到写完，否则干净的frame可能在写完之前被换出，再从disk读到旧数据
+  std::unique_ptr<char, decltype(&std::free)> buffer(
+      static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, std::max<size_t>(frames.size(), 1) * BUSTUB_PAGE_SIZE)),
+      &std::free);
+  std::vector<std::future<void>> writes;
+  writes.reserve(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    Page &page = part.GetPage(frames[i]);
+    char *data = buffer.get() + i * BUSTUB_PAGE_SIZE;
+    page.RLatch();
+    memcpy(data, page.data_, BUSTUB_PAGE_SIZE);
+    page.RUnlatch();
+    writes.push_back(disk_manager_->WritePageAsync(page.page_id_, data));
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+
+  lock.lock();
+  for (auto frame_id : frames) {
+    ReleasePinLocked(part, frame_id);
+  }
+  CountStat(StatCounter::FlusherWrites, frames.size());
+  return frames.size();
+}
+
+auto BufferPoolManager::PrefetchPage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  auto &part = GetPartition(page_id);
+  frame_id_t frame_id;
+  {
+    std::lock_guard<std::mutex> lock(part.latch_);
+    // 当作scan访问记录，如果没有人用到会被优先换出
+    if (!ClaimPrefetchFrame(part, page_id, AccessType::Scan, &frame_id)) {
+      return false;
+    }
+  }
+  CountStat(StatCounter::Prefetches);
+  SchedulePrefetch({PrefetchRequest{&part, frame_id, page_id}});
+  return true;
+}
+
+auto BufferPoolManager::ClaimPrefetchFrame(Partition &part, page_id_t page_id, AccessType access_type,
+                                           frame_id_t *frame_id) -> bool {
+  if (part.Table().Find(page_id, frame_id) || part.writeback_table_.count(page_id) > 0) {
+    return false;
+  }
+  if (!PopFreeFrame(part, frame_id)) {
+    // 只替换干净的unpinned page，预读不应该引起写disk
+    auto candidates = part.replacer_->EvictionCandidates(1);
+    if (candidates.empty()) {
+      return false;
+    }
+    *frame_id = candidates[0];
+    Page &victim = part.GetPage(*frame_id);
+    if (part.has_quotas_ && EvictionRank(part, victim) > static_cast<int>(BufferPriority::Normal)) {
+      // 预读不换出受保护的page
+      return false;
+    }
+    int pin_count = 0;
+    if (!victim.pin_count_.compare_exchange_strong(pin_count, Page::PIN_CLAIMED, std::memory_order_acq_rel)) {
+      return false;
+    }
+    if (victim.is_dirty_) {
+      victim.pin_count_.store(0, std::memory_order_release);
+      return false;
+    }
+    part.replacer_->Remove(*frame_id);
+    part.Table().Erase(victim.page_id_);
+    DetachFrameGroup(part, victim);
+  }
+  Page &page = part.GetPage(*frame_id);
+  page.is_dirty_ = false;
+  part.IOInProgress(*frame_id) = true;
+  // 读完之前不能被换出
+  PublishFrame(part, *frame_id, page_id, 0, access_type, false);
+  return true;
+}
+
+void BufferPoolManager::SchedulePrefetch(const std::vector<PrefetchRequest> &requests) {
+  std::lock_guard<std::mutex> prefetch_lock(prefetch_latch_);
+  prefetch_queue_.insert(prefetch_queue_.end(), requests.begin(), requests.end());
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManager::RunPrefetch, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+auto BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) -> size_t {
+  size_t scheduled = 0;
+  for (auto page_id : page_ids) {
+    if (PrefetchPage(page_id)) {
+      scheduled++;
+    }
+  }
+  return scheduled;
+}
+
+auto BufferPoolManager::DumpResidentPages(const std::string &path) -> size_t {
+  // 每个partition内按热度排序: 不可换出的frame(被pin住或正在读)最热，然后是replacer换出顺序的逆序
+  std::vector<std::vector<page_id_t>> ranked(partitions_.size());
+  for (size_t i = 0; i < partitions_.size(); ++i) {
+    auto &part = *partitions_[i];
+    std::lock_guard<std::mutex> lock(part.latch_);
+    DrainAccesses(part);
+    auto candidates = part.replacer_->EvictionCandidates(part.pool_size_);
+    std::vector<bool> evictable(part.pool_size_);
+    for (auto frame_id : candidates) {
+      if (static_cast<size_t>(frame_id) < evictable.size()) {
+        evictable[frame_id] = true;
+      }
+    }
+    part.Table().ForEach([&](page_id_t page_id, frame_id_t frame_id) {
+      if (static_cast<size_t>(frame_id) >= evictable.size() || !evictable[frame_id]) {
+        ranked[i].push_back(page_id);
+      }
+    });
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+      ranked[i].push_back(part.GetPage(*it).page_id_);
+    }
+  }
+  // 各个partition轮流取，保证整体上热的page在前面
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; page_ids.size() < pool_size_; ++rank) {
+    bool any = false;
+    for (auto &pages : ranked) {
+      if (rank < pages.size()) {
+        page_ids.push_back(pages[rank]);
+        any = true;
+      }
+    }
+    if (!any) {
+      break;
+    }
+  }
+
+  WarmUpHeader header;
+  header.count_ = page_ids.size();
+  std::string tmp_path = path + ".tmp";
+  std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(page_ids.data()),
+            static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  out.close();
+  if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG_WARN("failed to write the warm-up file %s", path.c_str());
+    return 0;
+  }
+  return page_ids.size();
+}
+
+auto BufferPoolManager::WarmUp(const std::string &path) -> size_t {
+  std::ifstream in(path, std::ios::binary);
+  WarmUpHeader header;
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      memcmp(header.magic_, WarmUpHeader().magic_, sizeof(header.magic_)) != 0 ||
+      header.page_size_ != BUSTUB_PAGE_SIZE) {
+    return 0;
+  }
+  std::vector<page_id_t> page_ids(std::min<uint64_t>(header.count_, pool_size_));
+  in.read(reinterpret_cast<char *>(page_ids.data()), static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  page_ids.resize(in.gcount() / sizeof(page_id_t));
+
+  // 从冷到热claim，最热的page在replacer中是最近访问的
+  std::vector<PrefetchRequest> requests;
+  for (auto it = page_ids.rbegin(); it != page_ids.rend(); ++it) {
+    page_id_t page_id = *it;
+    if (page_id < 0 || disk_manager_->IsPageFree(page_id)) {
+      continue;
+    }
+    auto &part = GetPartition(page_id);
+    std::lock_guard<std::mutex> lock(part.latch_);
+    // 这些page已经分配过，NewPage不能再用它们的id
+    if (page_id >= part.next_page_id_) {
+      auto stride = static_cast<page_id_t>(partitions_.size());
+      part.next_page_id_ = page_id + stride;
+    }
+    frame_id_t frame_id;
+    if (part.free_list_.empty() || !ClaimPrefetchFrame(part, page_id, AccessType::Unknown, &frame_id)) {
+      continue;
+    }
+    requests.push_back(PrefetchRequest{&part, frame_id, page_id});
+  }
+  if (!requests.empty()) {
+    CountStat(StatCounter::Prefetches, requests.size());
+    SchedulePrefetch(requests);
+  }
+  return requests.size();
+}
+
+auto BufferPoolManager::IsPageCached(page_id_t page_id) -> bool {
+  auto &part = GetPartition(page_id);
+  frame_id_t frame_id;
+  return part.Table().Find(page_id, &frame_id) && part.GetPage(frame_id).page_id_ == page_id &&
+         !part.IOInProgress(frame_id);
+}
+
+auto BufferPoolManager::CreateBufferGroup() -> buffer_group_t { return next_buffer_group_.fetch_add(1); }
+
+void BufferPoolManager::SetBufferQuota(buffer_group_t group, const BufferQuota &quota) {
+  BUSTUB_ENSURE(group != DEFAULT_BUFFER_GROUP, "the default buffer group cannot have a quota");
+  std::lock_guard<std::mutex> quota_lock(quota_latch_);
+  quotas_[group] = quota;
+  bool has_quotas = std::any_of(quotas_.begin(), quotas_.end(), [](const auto &entry) {
+    return entry.second.min_frames_ > 0 || entry.second.priority_ != BufferPriority::Normal;
+  });
+  size_t num_partitions = partitions_.size();
+  for (auto &part : partitions_) {
+    std::lock_guard<std::mutex> lock(part->latch_);
+    // 预留的frame平均分给各个partition，向上取整
+    auto &state = GroupOf(*part, group);
+    state.reserved_frames_ = (quota.min_frames_ + num_partitions - 1) / num_partitions;
+    state.priority_ = quota.priority_;
+    part->has_quotas_ = has_quotas;
+  }
+}
+
+auto BufferPoolManager::GetBufferQuota(buffer_group_t group) -> BufferQuota {
+  std::lock_guard<std::mutex> quota_lock(quota_latch_);
+  auto it = quotas_.find(group);
+  return it == quotas_.end() ? BufferQuota{} : it->second;
+}
+
+void BufferPoolManager::SetPageGroup(page_id_t page_id, buffer_group_t group) {
+  auto &part = GetPartition(page_id);
+  std::lock_guard<std::mutex> lock(part.latch_);
+  if (group == DEFAULT_BUFFER_GROUP) {
+    part.page_groups_.erase(page_id);
+  } else {
+    part.page_groups_[page_id] = group;
+  }
+  // 已经在buffer pool中的page马上计入新的group
+  frame_id_t frame_id;
+  if (part.Table().Find(page_id, &frame_id)) {
+    Page &page = part.GetPage(frame_id);
+    DetachFrameGroup(part, page);
+    page.buffer_group_ = group;
+    if (group != DEFAULT_BUFFER_GROUP) {
+      GroupOf(part, group).resident_frames_++;
+    }
+  }
+}
+
+auto BufferPoolManager::GetResidentFrames(buffer_group_t group) -> size_t {
+  size_t frames = 0;
+  for (auto &part : partitions_) {
+    std::lock_guard<std::mutex> lock(part->latch_);
+    if (group < part->groups_.size()) {
+      frames += part->groups_[group].resident_frames_;
+    }
+  }
+  return frames;
+}
+
+auto BufferPoolManager::GetStats() const -> BufferPoolStats {
+  auto get = [this](StatCounter counter) { return stats_.Get(static_cast<size_t>(counter)); };
+  BufferPoolStats stats;
+  stats.hits_ = get(StatCounter::Hits);
+  stats.misses_ = get(StatCounter::Misses);
+  stats.evictions_ = get(StatCounter::Evictions);
+  stats.dirty_writebacks_ = get(StatCounter::DirtyWritebacks);
+  stats.flusher_writes_ = get(StatCounter::FlusherWrites);
+  stats.io_waits_ = get(StatCounter::IOWaits);
+  stats.no_free_frame_ = get(StatCounter::NoFreeFrame);
+  stats.new_pages_ = get(StatCounter::NewPages);
+  stats.prefetches_ = get(StatCounter::Prefetches);
+  stats.miss_latency_ = stats_.GetHistogram(static_cast<size_t>(StatHistogram::MissLatency));
+  stats.io_wait_latency_ = stats_.GetHistogram(static_cast<size_t>(StatHistogram::IOWaitLatency));
+  return stats;
+}
+
+void BufferPoolManager::ResetStats() { stats_.Reset(); }
+
+void BufferPoolManager::RunPrefetch() {
+  while (true) {
+    std::unique_lock<std::mutex> prefetch_lock(prefetch_latch_);
+    prefetch_cv_.wait(prefetch_lock, [this] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // 一次性提交队列中所有的读请求
+    std::vector<PrefetchRequest> requests(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    prefetch_lock.unlock();
+
+    // 按page id排序，连续的page合并成一次vectored read
+    std::sort(requests.begin(), requests.end(),
+              [](const PrefetchRequest &a, const PrefetchRequest &b) { return a.page_id_ < b.page_id_; });
+    std::vector<std::pair<size_t, std::future<void>>> reads;
+    size_t run_start = 0;
+    while (run_start < requests.size()) {
+      Page &page = requests[run_start].part_->GetPage(requests[run_start].frame_id_);
+      bool is_dirty = false;
+      if (compressed_cache_ != nullptr && compressed_cache_->Take(requests[run_start].page_id_, page.data_, &is_dirty)) {
+        // 压缩缓存命中，不需要读disk
+        page.is_dirty_ = is_dirty;
+        std::promise<void> done;
+        done.set_value();
+        reads.emplace_back(++run_start, done.get_future());
+        continue;
+      }
+      std::vector<char *> run{page.data_};
+      size_t run_end = run_start + 1;
+      while (run_end < requests.size() && requests[run_end].page_id_ == requests[run_end - 1].page_id_ + 1 &&
+             (compressed_cache_ == nullptr || !compressed_cache_->Contains(requests[run_end].page_id_))) {
+        run.push_back(requests[run_end].part_->GetPage(requests[run_end].frame_id_).data_);
+        run_end++;
+      }
+      reads.emplace_back(run_end, disk_manager_->ReadPagesAsync(requests[run_start].page_id_, run));
+      run_start = run_end;
+    }
+    size_t done = 0;
+    for (auto &[run_end, read] : reads) {
+      read.wait();
+      for (; done < run_end; done++) {
+        Partition &part = *requests[done].part_;
+        frame_id_t frame_id = requests[done].frame_id_;
+        std::lock_guard<std::mutex> lock(part.latch_);
+        FinishFrameIO(part, frame_id, INVALID_PAGE_ID);
+        // 读完之后可以换出，已经被pin住的frame在claim时会失败
+        part.GetPage(frame_id).pin_count_.fetch_and(~Page::PIN_NOT_EVICTABLE, std::memory_order_acq_rel);
+        part.replacer_->SetEvictable(frame_id, true);
+      }
+    }
+  }
+}
+
+auto BufferPoolManager::ReadPageOptimistic(page_id_t page_id, uint64_t *version) -> const Page * {
+  auto &part = GetPartition(page_id);
+  frame_id_t frame_id;
+  if (!part.Table().Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  const Page &page = part.GetPage(frame_id);
+  // 先读版本号再检查frame，之后frame被换成别的page时PublishFrame会改变版本号
+  *version = page.GetVersion();
+  if ((*version & 1) != 0 || page.pin_count_.load(std::memory_order_acquire) == Page::PIN_CLAIMED ||
+      page.page_id_.load(std::memory_order_acquire) != page_id ||
+      part.IOInProgress(frame_id).load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &page;
+}
+
+auto BufferPoolManager::ValidateOptimistic(const Page *page, page_id_t page_id, uint64_t version) -> bool {
+  // 被删除或者换出的frame在重新使用之前是claimed状态
+  return page->ValidateVersion(version) && page->page_id_.load(std::memory_order_relaxed) == page_id &&
+         page->pin_count_.load(std::memory_order_relaxed) != Page::PIN_CLAIMED;
+}
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  Page *page = FetchPage(page_id, access_type);
   page->RLatch();
   return {this, page};
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  Page *page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  Page *page = FetchPage(page_id, access_type);
   page->WLatch();
   return {this, page};
 }
 
+auto BufferPoolManager::FetchPageUpgradable(page_id_t page_id, AccessType access_type) -> UpgradablePageGuard {
+  Page *page = FetchPage(page_id, access_type);
+  page->ULatch();
+  return {this, page};
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
 
 }  // namespace bustub
@@ -11,19 +11,99 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/clock_replacer.h"
+#include "common/exception.h"
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : slots_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (evictable_size_ == 0) {
+    return false;
+  }
+  // 最多转两圈：第一圈清除所有reference bit，第二圈一定能找到victim
+  for (size_t step = 0; step < 2 * slots_.size(); step++) {
+    ClockSlot &slot = slots_[hand_];
+    size_t current = hand_;
+    hand_ = (hand_ + 1) % slots_.size();
+    if (!slot.is_tracked_ || !slot.is_evictable_) {
+      continue;
+    }
+    if (slot.ref_) {
+      slot.ref_ = false;
+      continue;
+    }
+    slot = ClockSlot{};
+    evictable_size_--;
+    *frame_id = static_cast<frame_id_t>(current);
+    return true;
+  }
+  UNREACHABLE("an evictable frame must be found within two sweeps");
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= slots_.size()) {
+    throw Exception("frame id is invalid");
+  }
+  ClockSlot &slot = slots_[frame_id];
+  slot.is_tracked_ = true;
+  if (access_type != AccessType::Scan) {
+    slot.ref_ = true;
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= slots_.size() || !slots_[frame_id].is_tracked_) {
+    throw Exception("frame id is invalid");
+  }
+  ClockSlot &slot = slots_[frame_id];
+  if (slot.is_evictable_ != set_evictable) {
+    slot.is_evictable_ = set_evictable;
+    if (set_evictable) {
+      evictable_size_++;
+    } else {
+      evictable_size_--;
+    }
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= slots_.size() || !slots_[frame_id].is_tracked_) {
+    return;
+  }
+  ClockSlot &slot = slots_[frame_id];
+  if (!slot.is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  slot = ClockSlot{};
+  evictable_size_--;
+}
+
+auto ClockReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return evictable_size_;
+}
+
+auto ClockReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // 模拟时钟指针：第一圈是reference bit为0的frame，第二圈是reference bit为1的frame
+  for (bool ref : {false, true}) {
+    for (size_t step = 0; step < slots_.size() && candidates.size() < max_count; step++) {
+      size_t current = (hand_ + step) % slots_.size();
+      const ClockSlot &slot = slots_[current];
+      if (slot.is_tracked_ && slot.is_evictable_ && slot.ref_ == ref) {
+        candidates.push_back(static_cast<frame_id_t>(current));
+      }
+    }
+  }
+  return candidates;
+}
 
 }  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "common/macros.h"
+#include "lzf/lzf.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(DiskManager *disk_manager, size_t capacity)
+    : disk_manager_(disk_manager), shard_capacity_(capacity / NUM_SHARDS) {}
+
+void CompressedPageCache::Put(page_id_t page_id, const char *page_data, bool is_dirty) {
+  // 在latch外压缩，压缩后不比原page小的按原样保存
+  char buffer[BUSTUB_PAGE_SIZE];
+  size_t compressed_size = lzf::Compress(page_data, BUSTUB_PAGE_SIZE, buffer, BUSTUB_PAGE_SIZE - 1);
+  Entry entry{page_id, is_dirty, compressed_size, nullptr};
+  entry.data_ = std::make_unique<char[]>(entry.Size());
+  memcpy(entry.data_.get(), compressed_size == 0 ? page_data : buffer, entry.Size());
+
+  auto &shard = ShardOf(page_id);
+  std::lock_guard<std::mutex> lock(shard.latch_);
+  if (auto it = shard.entries_.find(page_id); it != shard.entries_.end()) {
+    RemoveEntry(shard, it->second);
+  }
+  shard.bytes_ += entry.Size();
+  compressed_bytes_ += entry.Size();
+  pages_++;
+  shard.lru_.push_front(std::move(entry));
+  shard.entries_.emplace(page_id, shard.lru_.begin());
+
+  // 超过容量时丢弃最早放入的page，dirty page要先写回disk
+  while (shard.bytes_ > shard_capacity_) {
+    auto victim = std::prev(shard.lru_.end());
+    if (victim->is_dirty_) {
+      Decode(*victim, buffer);
+      disk_manager_->WritePage(victim->page_id_, buffer);
+      writebacks_++;
+    }
+    evictions_++;
+    RemoveEntry(shard, victim);
+  }
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *page_data, bool *is_dirty) -> bool {
+  auto &shard = ShardOf(page_id);
+  std::lock_guard<std::mutex> lock(shard.latch_);
+  auto it = shard.entries_.find(page_id);
+  if (it == shard.entries_.end()) {
+    misses_++;
+    return false;
+  }
+  hits_++;
+  Decode(*it->second, page_data);
+  *is_dirty = it->second->is_dirty_;
+  RemoveEntry(shard, it->second);
+  return true;
+}
+
+auto CompressedPageCache::Contains(page_id_t page_id) -> bool {
+  auto &shard = ShardOf(page_id);
+  std::lock_guard<std::mutex> lock(shard.latch_);
+  return shard.entries_.count(page_id) > 0;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  auto &shard = ShardOf(page_id);
+  std::lock_guard<std::mutex> lock(shard.latch_);
+  if (auto it = shard.entries_.find(page_id); it != shard.entries_.end()) {
+    RemoveEntry(shard, it->second);
+  }
+}
+
+auto CompressedPageCache::Flush() -> size_t {
+  char buffer[BUSTUB_PAGE_SIZE];
+  size_t written = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.latch_);
+    for (auto &entry : shard.lru_) {
+      if (entry.is_dirty_) {
+        Decode(entry, buffer);
+        disk_manager_->WritePage(entry.page_id_, buffer);
+        entry.is_dirty_ = false;
+        written++;
+      }
+    }
+  }
+  return written;
+}
+
+auto CompressedPageCache::GetStats() const -> CompressedPageCacheStats {
+  CompressedPageCacheStats stats;
+  stats.hits_ = hits_;
+  stats.misses_ = misses_;
+  stats.evictions_ = evictions_;
+  stats.writebacks_ = writebacks_;
+  stats.pages_ = pages_;
+  stats.compressed_bytes_ = compressed_bytes_;
+  return stats;
+}
+
+void CompressedPageCache::ResetStats() {
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+  writebacks_ = 0;
+}
+
+void CompressedPageCache::Decode(const Entry &entry, char *page_data) {
+  if (entry.compressed_size_ == 0) {
+    memcpy(page_data, entry.data_.get(), BUSTUB_PAGE_SIZE);
+    return;
+  }
+  size_t size = lzf::Decompress(entry.data_.get(), entry.compressed_size_, page_data, BUSTUB_PAGE_SIZE);
+  BUSTUB_ENSURE(size == BUSTUB_PAGE_SIZE, "corrupt page in the compressed page cache");
+}
+
+void CompressedPageCache::RemoveEntry(Shard &shard, std::list<Entry>::iterator it) {
+  shard.bytes_ -= it->Size();
+  compressed_bytes_ -= it->Size();
+  pages_--;
+  shard.entries_.erase(it->page_id_);
+  shard.lru_.erase(it);
+}
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BUSTUB_FRAME_ARENA_GUARD 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BUSTUB_FRAME_ARENA_GUARD 1
+#endif
+#endif
+
+#ifdef BUSTUB_FRAME_ARENA_GUARD
+#include <sanitizer/asan_interface.h>
+#endif
+
+namespace bustub {
+
+auto FrameArenaBackingToString(FrameArenaBacking backing) -> std::string {
+  switch (backing) {
+    case FrameArenaBacking::Pages:
+      return "pages";
+    case FrameArenaBacking::TransparentHugePages:
+      return "transparent_huge_pages";
+    case FrameArenaBacking::HugeTlb:
+      return "hugetlb";
+  }
+  return "unknown";
+}
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages) : num_frames_(num_frames) {
+#ifdef BUSTUB_FRAME_ARENA_GUARD
+  stride_ = 2 * BUSTUB_PAGE_SIZE;
+#else
+  stride_ = BUSTUB_PAGE_SIZE;
+#endif
+  size_t size = num_frames * stride_;
+  auto huge_page_size = use_huge_pages ? HugePageSize() : std::nullopt;
+  if (huge_page_size.has_value() && size >= *huge_page_size) {
+    // 先尝试hugetlb，没有预留huge page时会失败
+    size_t huge_size = (size + *huge_page_size - 1) / *huge_page_size * *huge_page_size;
+    void *addr = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+      base_ = static_cast<char *>(addr);
+      mapped_size_ = huge_size;
+      backing_ = FrameArenaBacking::HugeTlb;
+    } else if (auto *aligned = MapAligned(size, *huge_page_size); aligned != nullptr) {
+      // transparent huge page要求按huge page对齐
+      base_ = aligned;
+      mapped_size_ = size;
+      if (madvise(base_, size, MADV_HUGEPAGE) == 0) {
+        backing_ = FrameArenaBacking::TransparentHugePages;
+      }
+    }
+  }
+  if (base_ == nullptr) {
+    base_ = MapAligned(size, BUSTUB_PAGE_SIZE);
+    if (base_ == nullptr) {
+      throw Exception(fmt::format("cannot map {} bytes for buffer pool frames: {}", size, strerror(errno)));
+    }
+    mapped_size_ = size;
+  }
+#ifdef BUSTUB_FRAME_ARENA_GUARD
+  for (size_t i = 0; i < num_frames_; ++i) {
+    ASAN_POISON_MEMORY_REGION(GetFrame(i) + BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE);
+  }
+#endif
+}
+
+FrameArena::~FrameArena() {
+#ifdef BUSTUB_FRAME_ARENA_GUARD
+  ASAN_UNPOISON_MEMORY_REGION(base_, mapped_size_);
+#endif
+  munmap(base_, mapped_size_);
+}
+
+void FrameArena::Discard(size_t index) {
+  // hugetlb不能只释放一个page，这时只清零
+  if (backing_ == FrameArenaBacking::HugeTlb || madvise(GetFrame(index), BUSTUB_PAGE_SIZE, MADV_DONTNEED) != 0) {
+    memset(GetFrame(index), 0, BUSTUB_PAGE_SIZE);
+  }
+}
+
+auto FrameArena::MapAligned(size_t size, size_t alignment) -> char * {
+  // 多映射alignment字节，对齐后把头尾还回去
+  void *addr = mmap(nullptr, size + alignment, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+  auto start = reinterpret_cast<uintptr_t>(addr);
+  auto aligned = (start + alignment - 1) / alignment * alignment;
+  if (aligned > start) {
+    munmap(addr, aligned - start);
+  }
+  munmap(reinterpret_cast<char *>(aligned + size), start + alignment - aligned);
+  return reinterpret_cast<char *>(aligned);
+}
+
+auto FrameArena::HugePageSize() -> std::optional<size_t> {
+  static const std::optional<size_t> HUGE_PAGE_SIZE = []() -> std::optional<size_t> {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    size_t value;
+    while (meminfo >> key >> value) {
+      if (key == "Hugepagesize:") {
+        return value * 1024;
+      }
+      meminfo.ignore(256, '\n');
+    }
+    return std::nullopt;
+  }();
+  return HUGE_PAGE_SIZE;
+}
+
+}  // namespace bustub
@@ -15,93 +15,121 @@
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : node_store_(num_frames), history_(num_frames * k), replacer_size_(num_frames), k_(k) {
+  BUSTUB_ASSERT(k > 0, "k of the LRU-K replacer must be positive");
+}
+
+auto LRUKReplacer::EvictionKey(frame_id_t frame_id) -> std::pair<size_t, frame_id_t> {
+  // 不足k次访问时是最早一次访问的时间戳，否则是倒数第k次访问的时间戳，都是ring buffer中最旧的那个
+  const LRUKNode &node = node_store_[frame_id];
+  return std::make_pair(history_[frame_id * k_ + node.GetOldest()], frame_id);
+}
+
+auto LRUKReplacer::PopulationOf(frame_id_t frame_id) -> std::set<std::pair<size_t, frame_id_t>> & {
+  const LRUKNode &node = node_store_[frame_id];
+  if (node.IsScanOnly()) {
+    return scan_only_;
+  }
+  return node.GetHistorySize() < k_ ? less_than_k_ : full_history_;
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::lock_guard<std::mutex> lock(latch_);
   current_timestamp_++;
-  size_t max_k_distance = 0;
-  size_t max_last_access_time = 0;     // 距离最近一次访问的时间差
-  auto target_it = node_store_.end();  // 用于保存指定位置的迭代器
-  for (auto it = node_store_.begin(); it != node_store_.end(); it++) {
-    if (!it->second.IsEvictable()) {
-      continue;
-    }
-    size_t cur_k_distance;
-    size_t cur_last_access_time;
-    if (it->second.GetHistory().size() < k_) {
-      cur_k_distance = std::numeric_limits<int>::max();
-      cur_last_access_time = current_timestamp_ - it->second.GetHistory().back();
-    } else {
-      cur_k_distance = current_timestamp_ - it->second.GetHistory().back();
-      cur_last_access_time = current_timestamp_ - it->second.GetHistory().front();
-    }
-    if (cur_k_distance > max_k_distance ||
-        (cur_k_distance == max_k_distance && cur_last_access_time > max_last_access_time)) {
-      max_k_distance = cur_k_distance;
-      max_last_access_time = cur_last_access_time;
-      target_it = it;
-    }
+  // 只被scan访问过的frame最先换出，其次是backward k-distance为+inf的frame
+  auto *population = &scan_only_;
+  if (population->empty()) {
+    population = less_than_k_.empty() ? &full_history_ : &less_than_k_;
   }
-  if (target_it == node_store_.end()) {
-    frame_id = nullptr;
+  if (population->empty()) {
     return false;
   }
-  *frame_id = target_it->first;
-  node_store_.erase(target_it->first);
+  *frame_id = population->begin()->second;
+  population->erase(population->begin());
+  node_store_[*frame_id].Reset();
   evictable_size_--;
   curr_size_--;
   return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
   std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw Exception("frame id is invalid");
+  }
   current_timestamp_++;
-  if (node_store_.find(frame_id) != node_store_.end()) {
-    // 之前存在，更新一下accessTime
-    node_store_[frame_id].AddHistory(current_timestamp_);
-  } else {
-    if (curr_size_ >= replacer_size_) {
-      throw Exception("larger than replacer_size_");
-    }
+  LRUKNode &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.IsTracked() && is_scan && !node.IsScanOnly()) {
+    // scan不算作一次引用，不改变已有的访问历史
+    return;
+  }
+  if (node.IsEvictable()) {
+    // 时间戳变化后需要重新排序
+    PopulationOf(frame_id).erase(EvictionKey(frame_id));
+  }
+  if (!node.IsTracked()) {
     // 之前不存在，插入新的record
-    LRUKNode lruknode = LRUKNode(k_, frame_id);
-    lruknode.AddHistory(current_timestamp_);
-    node_store_.insert(std::make_pair(frame_id, lruknode));
     curr_size_++;
+    node.SetScanOnly(is_scan);
+  } else if (node.IsScanOnly() && !is_scan) {
+    // 第一次被非scan访问，之前scan留下的时间戳不算数
+    bool is_evictable = node.IsEvictable();
+    node.Reset();
+    node.SetIsEvictable(is_evictable);
+  }
+  node.AddHistory(&history_[frame_id * k_], k_, current_timestamp_);
+  if (node.IsEvictable()) {
+    PopulationOf(frame_id).insert(EvictionKey(frame_id));
   }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::lock_guard<std::mutex> lock(latch_);
-  if (node_store_.find(frame_id) == node_store_.end()) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ || !node_store_[frame_id].IsTracked()) {
     throw Exception("frame id is invalid");
   }
-  bool cur_is_evictable = node_store_[frame_id].IsEvictable();
+  LRUKNode &node = node_store_[frame_id];
+  bool cur_is_evictable = node.IsEvictable();
   if (cur_is_evictable && !set_evictable) {
-    node_store_[frame_id].SetIsEvictable(set_evictable);
+    PopulationOf(frame_id).erase(EvictionKey(frame_id));
+    node.SetIsEvictable(set_evictable);
     evictable_size_--;
   }
   if (!cur_is_evictable && set_evictable) {
-    node_store_[frame_id].SetIsEvictable(set_evictable);
+    PopulationOf(frame_id).insert(EvictionKey(frame_id));
+    node.SetIsEvictable(set_evictable);
     evictable_size_++;
   }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::lock_guard<std::mutex> lock(latch_);
-  if (node_store_.find(frame_id) == node_store_.end()) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ || !node_store_[frame_id].IsTracked()) {
     return;
   }
-  bool is_evictable = node_store_[frame_id].IsEvictable();
-  if (!is_evictable) {
+  LRUKNode &node = node_store_[frame_id];
+  if (!node.IsEvictable()) {
     throw Exception("non-evictable frame");
   }
-  node_store_.erase(frame_id);
+  PopulationOf(frame_id).erase(EvictionKey(frame_id));
+  node.Reset();
   evictable_size_--;
   curr_size_--;
 }
 
 auto LRUKReplacer::Size() -> size_t { return evictable_size_; }
 
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (const auto *population : {&scan_only_, &less_than_k_, &full_history_}) {
+    for (auto it = population->begin(); it != population->end() && candidates.size() < max_count; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
 }  // namespace bustub
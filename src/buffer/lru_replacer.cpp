@@ -11,19 +11,86 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_replacer.h"
+#include "common/exception.h"
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : node_store_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (lru_.empty()) {
+    return false;
+  }
+  *frame_id = lru_.begin()->second;
+  lru_.erase(lru_.begin());
+  node_store_[*frame_id] = LRUNode{};
+  return true;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, [[maybe_unused]] page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size()) {
+    throw Exception("frame id is invalid");
+  }
+  LRUNode &node = node_store_[frame_id];
+  if (node.last_access_ != 0 && access_type == AccessType::Scan) {
+    // scan不刷新已有frame的访问时间
+    return;
+  }
+  if (node.is_evictable_) {
+    lru_.erase(std::make_pair(node.last_access_, frame_id));
+  }
+  node.last_access_ = ++current_timestamp_;
+  if (node.is_evictable_) {
+    lru_.insert(std::make_pair(node.last_access_, frame_id));
+  }
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() || node_store_[frame_id].last_access_ == 0) {
+    throw Exception("frame id is invalid");
+  }
+  LRUNode &node = node_store_[frame_id];
+  if (node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    lru_.insert(std::make_pair(node.last_access_, frame_id));
+  } else {
+    lru_.erase(std::make_pair(node.last_access_, frame_id));
+  }
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() || node_store_[frame_id].last_access_ == 0) {
+    return;
+  }
+  LRUNode &node = node_store_[frame_id];
+  if (!node.is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  lru_.erase(std::make_pair(node.last_access_, frame_id));
+  node = LRUNode{};
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return lru_.size();
+}
+
+auto LRUReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = lru_.begin(); it != lru_.end() && candidates.size() < max_count; ++it) {
+    candidates.push_back(it->second);
+  }
+  return candidates;
+}
 
 }  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  // 负载不超过1/2，线性探测的查找路径很短
+  size_t capacity = 2;
+  while (capacity < 2 * max_entries) {
+    capacity <<= 1;
+  }
+  mask_ = capacity - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeOf(page_id_t page_id) const -> size_t {
+  // 同一个partition的page id是等差的，先打散再取模
+  uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL;
+  return (hash >> 32) & mask_;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (PageIdOf(slot) == page_id) {
+      *frame_id = FrameIdOf(slot);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(size_ < mask_, "page table is full");
+  size_t i = HomeOf(page_id);
+  while (slots_[i].load(std::memory_order_relaxed) != EMPTY) {
+    i = (i + 1) & mask_;
+  }
+  slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+  size_++;
+}
+
+auto PageTable::Erase(page_id_t page_id) -> bool {
+  size_t i = HomeOf(page_id);
+  while (true) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return false;
+    }
+    if (PageIdOf(slot) == page_id) {
+      break;
+    }
+    i = (i + 1) & mask_;
+  }
+  // backward shift: 把后面探测链上的entry往前移，不留下tombstone
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask_;
+    uint64_t slot = slots_[j].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      break;
+    }
+    size_t home = HomeOf(PageIdOf(slot));
+    // home不在(i, j]之间的entry可以移到i
+    bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+    if (movable) {
+      slots_[i].store(slot, std::memory_order_release);
+      i = j;
+    }
+  }
+  slots_[i].store(EMPTY, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace bustub
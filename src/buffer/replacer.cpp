@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "common/macros.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto Replacer::Create(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer> {
+  switch (policy) {
+    case ReplacerPolicy::LRUK:
+      return std::make_unique<LRUKReplacer>(num_frames, k);
+    case ReplacerPolicy::LRU:
+      return std::make_unique<LRUReplacer>(num_frames);
+    case ReplacerPolicy::Clock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerPolicy::TwoQueue:
+      return std::make_unique<TwoQueueReplacer>(num_frames);
+    case ReplacerPolicy::ARC:
+      return std::make_unique<ArcReplacer>(num_frames);
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+auto ReplacerPolicyFromString(const std::string &name) -> std::optional<ReplacerPolicy> {
+  auto lower = StringUtil::Lower(name);
+  if (lower == "lru_k" || lower == "lru-k" || lower == "lruk") {
+    return ReplacerPolicy::LRUK;
+  }
+  if (lower == "lru") {
+    return ReplacerPolicy::LRU;
+  }
+  if (lower == "clock") {
+    return ReplacerPolicy::Clock;
+  }
+  if (lower == "2q") {
+    return ReplacerPolicy::TwoQueue;
+  }
+  if (lower == "arc") {
+    return ReplacerPolicy::ARC;
+  }
+  return std::nullopt;
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRUK:
+      return "lru_k";
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::Clock:
+      return "clock";
+    case ReplacerPolicy::TwoQueue:
+      return "2q";
+    case ReplacerPolicy::ARC:
+      return "arc";
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+}  // namespace bustub
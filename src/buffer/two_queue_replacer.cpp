@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : node_store_(num_frames), kin_(std::max<size_t>(1, num_frames / 4)), kout_(std::max<size_t>(1, num_frames / 2)) {}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+  // A1in超过目标大小或者Am中没有可以换出的frame时，从A1in换出
+  bool from_a1in = !a1in_.empty() && (a1in_size_ > kin_ || am_.empty());
+  auto &queue = from_a1in ? a1in_ : am_;
+  if (queue.empty()) {
+    return false;
+  }
+  *frame_id = queue.begin()->second;
+  EvictLocked(*frame_id);
+  return true;
+}
+
+void TwoQueueReplacer::EvictFrame(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].queue_ == Queue::None) {
+    return;
+  }
+  if (!node_store_[frame_id].is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  EvictLocked(frame_id);
+}
+
+void TwoQueueReplacer::EvictLocked(frame_id_t frame_id) {
+  TwoQueueNode &node = node_store_[frame_id];
+  QueueOf(node).erase(std::make_pair(node.timestamp_, frame_id));
+  if (node.queue_ == Queue::A1In) {
+    a1in_size_--;
+    // 只被scan访问过的page不记录到A1out
+    if (!node.scan_only_ && node.page_id_ != INVALID_PAGE_ID) {
+      a1out_.Push(node.page_id_);
+      if (a1out_.Size() > kout_) {
+        a1out_.PopOldest();
+      }
+    }
+  }
+  node = TwoQueueNode{};
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size()) {
+    throw Exception("frame id is invalid");
+  }
+  TwoQueueNode &node = node_store_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (node.queue_ == Queue::None) {
+    // 刚被换出不久的page直接进入Am
+    if (!is_scan && page_id != INVALID_PAGE_ID && a1out_.Take(page_id)) {
+      node.queue_ = Queue::Am;
+    } else {
+      node.queue_ = Queue::A1In;
+      node.scan_only_ = is_scan;
+      a1in_size_++;
+    }
+    node.timestamp_ = ++current_timestamp_;
+    node.page_id_ = page_id;
+    return;
+  }
+  if (is_scan) {
+    return;
+  }
+  node.scan_only_ = false;
+  if (node.queue_ == Queue::Am) {
+    // Am是LRU，刷新访问时间
+    if (node.is_evictable_) {
+      am_.erase(std::make_pair(node.timestamp_, frame_id));
+    }
+    node.timestamp_ = ++current_timestamp_;
+    if (node.is_evictable_) {
+      am_.insert(std::make_pair(node.timestamp_, frame_id));
+    }
+  }
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].queue_ == Queue::None) {
+    throw Exception("frame id is invalid");
+  }
+  TwoQueueNode &node = node_store_[frame_id];
+  if (node.is_evictable_ == set_evictable) {
+    return;
+  }
+  node.is_evictable_ = set_evictable;
+  if (set_evictable) {
+    QueueOf(node).insert(std::make_pair(node.timestamp_, frame_id));
+  } else {
+    QueueOf(node).erase(std::make_pair(node.timestamp_, frame_id));
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= node_store_.size() ||
+      node_store_[frame_id].queue_ == Queue::None) {
+    return;
+  }
+  TwoQueueNode &node = node_store_[frame_id];
+  if (!node.is_evictable_) {
+    throw Exception("non-evictable frame");
+  }
+  QueueOf(node).erase(std::make_pair(node.timestamp_, frame_id));
+  if (node.queue_ == Queue::A1In) {
+    a1in_size_--;
+  }
+  node = TwoQueueNode{};
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return a1in_.size() + am_.size();
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // 先是A1in超出目标大小的部分，然后是Am，最后是A1in剩下的部分
+  size_t a1in_excess = a1in_size_ > kin_ ? a1in_size_ - kin_ : 0;
+  auto a1in_it = a1in_.begin();
+  for (; a1in_it != a1in_.end() && a1in_excess > 0 && candidates.size() < max_count; ++a1in_it, --a1in_excess) {
+    candidates.push_back(a1in_it->second);
+  }
+  for (auto it = am_.begin(); it != am_.end() && candidates.size() < max_count; ++it) {
+    candidates.push_back(it->second);
+  }
+  for (; a1in_it != a1in_.end() && candidates.size() < max_count; ++a1in_it) {
+    candidates.push_back(a1in_it->second);
+  }
+  return candidates;
+}
+
+}  // namespace bustub
@@ -1,6 +1,7 @@
 // DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
 // variable.
 
+#include <charconv>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -133,6 +134,74 @@ void BustubInstance::HandleVariableShowStatement(Transaction *txn, const Variabl
 
 void BustubInstance::HandleVariableSetStatement(Transaction *txn, const VariableSetStatement &stmt,
                                                 ResultWriter &writer) {
+  if (stmt.variable_ == "buffer_pool_replacer") {
+    auto policy = ReplacerPolicyFromString(stmt.value_);
+    if (!policy.has_value()) {
+      throw Exception(fmt::format("unknown buffer pool replacer: {}", stmt.value_));
+    }
+    if (buffer_pool_manager_ == nullptr) {
+      throw NotImplementedException("buffer pool manager is not available");
+    }
+    buffer_pool_manager_->SetReplacerPolicy(*policy);
+  }
+  if (stmt.variable_ == "disk_sync_policy") {
+    auto policy = DiskSyncPolicyFromString(stmt.value_);
+    if (!policy.has_value()) {
+      throw Exception(fmt::format("unknown disk sync policy: {}", stmt.value_));
+    }
+    if (disk_manager_ == nullptr) {
+      throw NotImplementedException("disk manager is not available");
+    }
+    disk_manager_->SetSyncPolicy(*policy);
+  }
+  if (stmt.variable_ == "buffer_pool_size") {
+    size_t pool_size = 0;
+    auto [end, ec] = std::from_chars(stmt.value_.data(), stmt.value_.data() + stmt.value_.size(), pool_size);
+    if (ec != std::errc() || end != stmt.value_.data() + stmt.value_.size() || pool_size == 0) {
+      throw Exception(fmt::format("invalid buffer pool size: {}", stmt.value_));
+    }
+    if (buffer_pool_manager_ == nullptr) {
+      throw NotImplementedException("buffer pool manager is not available");
+    }
+    if (!buffer_pool_manager_->Resize(pool_size)) {
+      throw Exception(fmt::format("buffer pool could only shrink to {} frames, some pages are still pinned",
+                                  buffer_pool_manager_->GetPoolSize()));
+    }
+  }
+  if (stmt.variable_ == "buffer_pool_quota") {
+    // 格式: <table>[.<index>]:<min_frames>[:<priority>]
+    auto parts = StringUtil::Split(stmt.value_, ':');
+    if (parts.size() < 2 || parts.size() > 3 || parts[0].empty()) {
+      throw Exception(fmt::format("invalid buffer pool quota, expected <table>[.<index>]:<min_frames>[:<priority>]: {}",
+                                  stmt.value_));
+    }
+    BufferQuota quota;
+    const auto &frames = parts[1];
+    auto [end, ec] = std::from_chars(frames.data(), frames.data() + frames.size(), quota.min_frames_);
+    if (ec != std::errc() || end != frames.data() + frames.size()) {
+      throw Exception(fmt::format("invalid number of reserved frames: {}", frames));
+    }
+    if (parts.size() == 3) {
+      auto priority = BufferPriorityFromString(parts[2]);
+      if (!priority.has_value()) {
+        throw Exception(fmt::format("unknown buffer priority: {}", parts[2]));
+      }
+      quota.priority_ = *priority;
+    }
+    std::unique_lock<std::shared_mutex> l(catalog_lock_);
+    auto dot = parts[0].find('.');
+    if (dot == std::string::npos) {
+      if (!catalog_->SetTableBufferQuota(parts[0], quota)) {
+        throw Exception(fmt::format("table {} not found", parts[0]));
+      }
+    } else {
+      auto table_name = parts[0].substr(0, dot);
+      auto index_name = parts[0].substr(dot + 1);
+      if (!catalog_->SetIndexBufferQuota(index_name, table_name, quota)) {
+        throw Exception(fmt::format("index {} on table {} not found", index_name, table_name));
+      }
+    }
+  }
   session_variables_[stmt.variable_] = stmt.value_;
 }
 
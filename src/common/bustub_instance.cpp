@@ -2,6 +2,8 @@
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -60,6 +62,13 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
     buffer_pool_manager_ = nullptr;
   }
 
+  if (buffer_pool_manager_ != nullptr) {
+    // 预热上次退出时在buffer pool中的page，并在退出和运行期间更新这个列表
+    auto warmup_file = db_file_name.substr(0, db_file_name.rfind('.')) + ".warmup";
+    buffer_pool_manager_->WarmUp(warmup_file);
+    buffer_pool_manager_->SetWarmUpFile(warmup_file);
+  }
+
   // Transaction (txn) related.
 
   lock_manager_ = new LockManager();
@@ -70,6 +79,9 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
 
 #ifndef __EMSCRIPTEN__
   lock_manager_->StartDeadlockDetection();
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StartBackgroundFlusher();
+  }
 #endif
 
   // Checkpoint related.
@@ -110,6 +122,9 @@ BustubInstance::BustubInstance() {
 
 #ifndef __EMSCRIPTEN__
   lock_manager_->StartDeadlockDetection();
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StartBackgroundFlusher();
+  }
 #endif
 
   // Checkpoint related.
@@ -163,6 +178,56 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBpmStats(ResultWriter &writer) {
+  auto bpm_stats = buffer_pool_manager_->GetStats();
+  auto disk_stats = disk_manager_->GetStats();
+  auto latency = [](const LatencyHistogram &histogram) {
+    return fmt::format("count={} mean={:.1f}us p50<{}us p99<{}us", histogram.Count(), histogram.Mean(),
+                       histogram.Percentile(0.5), histogram.Percentile(0.99));
+  };
+  std::vector<std::pair<std::string, std::string>> rows = {
+      {"pool_size", fmt::format("{}", buffer_pool_manager_->GetPoolSize())},
+      {"page_size", fmt::format("{}", BUSTUB_PAGE_SIZE)},
+      {"huge_page_frames", fmt::format("{}", buffer_pool_manager_->HugePageFrames())},
+      {"hits", fmt::format("{}", bpm_stats.hits_)},
+      {"misses", fmt::format("{}", bpm_stats.misses_)},
+      {"evictions", fmt::format("{}", bpm_stats.evictions_)},
+      {"dirty_writebacks", fmt::format("{}", bpm_stats.dirty_writebacks_)},
+      {"flusher_writes", fmt::format("{}", bpm_stats.flusher_writes_)},
+      {"io_waits", fmt::format("{}", bpm_stats.io_waits_)},
+      {"no_free_frame", fmt::format("{}", bpm_stats.no_free_frame_)},
+      {"new_pages", fmt::format("{}", bpm_stats.new_pages_)},
+      {"prefetches", fmt::format("{}", bpm_stats.prefetches_)},
+      {"miss_latency", latency(bpm_stats.miss_latency_)},
+      {"io_wait_latency", latency(bpm_stats.io_wait_latency_)},
+      {"disk_reads", fmt::format("{}", disk_stats.reads_)},
+      {"disk_writes", fmt::format("{}", disk_stats.writes_)},
+      {"disk_syncs", fmt::format("{}", disk_stats.syncs_)},
+      {"disk_read_latency", latency(disk_stats.read_latency_)},
+      {"disk_write_latency", latency(disk_stats.write_latency_)},
+      {"disk_sync_latency", latency(disk_stats.sync_latency_)},
+  };
+  if (auto *cache = buffer_pool_manager_->GetCompressedCache(); cache != nullptr) {
+    auto cache_stats = cache->GetStats();
+    rows.emplace_back("compressed_cache_pages", fmt::format("{}", cache_stats.pages_));
+    rows.emplace_back("compressed_cache_hit_rate", fmt::format("{:.3f}", cache_stats.HitRate()));
+    rows.emplace_back("compressed_cache_ratio", fmt::format("{:.2f}", cache_stats.CompressionRatio()));
+    rows.emplace_back("compressed_cache_writebacks", fmt::format("{}", cache_stats.writebacks_));
+  }
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("name");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : rows) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +241,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpm_stats: show buffer pool and disk statistics
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +282,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpm_stats") {
+      CmdDisplayBpmStats(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -351,6 +421,9 @@ void BustubInstance::GenerateMockTable() {
 }
 
 BustubInstance::~BustubInstance() {
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->StopBackgroundFlusher();
+  }
   if (enable_logging) {
     log_manager_->StopFlushThread();
   }
@@ -20,4 +20,24 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds bpm_flusher_interval = std::chrono::milliseconds(10);
+
+double bpm_flusher_low_watermark = 0.1;
+
+double bpm_flusher_high_watermark = 0.25;
+
+size_t bpm_flusher_max_pages = 32;
+
+size_t table_scan_read_ahead = 8;
+
+std::chrono::milliseconds bpm_resize_timeout = std::chrono::milliseconds(5000);
+
+std::chrono::milliseconds bpm_warmup_dump_interval = std::chrono::milliseconds(60000);
+
+size_t bpm_compressed_cache_size = 0;
+
+bool bpm_use_huge_pages = true;
+
+double bplustree_bulk_load_fill_factor = 0.9;
+
 }  // namespace bustub
@@ -12,6 +12,8 @@
 
 #include "execution/executors/insert_executor.h"
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace bustub {
 
@@ -43,6 +45,8 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   TupleMeta meta = {INVALID_TXN_ID, INVALID_TXN_ID, false};
   RID child_rid;
   Tuple child_tuple;
+  // 每个index要插入的数据，所有tuple插入之后再按key排序批量插入
+  std::vector<std::vector<std::pair<Tuple, RID>>> index_entries(indexes.size());
   while (child_executor_->Next(&child_tuple, &child_rid)) {
     size++;
     RID insert_rid;
@@ -56,14 +60,18 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     }
     // 维护table write set
     exec_ctx_->GetTransaction()->AppendTableWriteRecord(TableWriteRecord{plan_->TableOid(), insert_rid, table});
-    // 插入index
-    Tuple index_tuple;
-    for (IndexInfo *index_ptr : indexes) {
-      index_tuple = child_tuple.KeyFromTuple(catalog->GetTable(plan_->TableOid())->schema_, index_ptr->key_schema_,
-                                             index_ptr->index_->GetKeyAttrs());
-      index_ptr->index_->InsertEntry(index_tuple, insert_rid, nullptr);
+    // 记录要插入index的数据
+    for (size_t i = 0; i < indexes.size(); i++) {
+      index_entries[i].emplace_back(
+          child_tuple.KeyFromTuple(catalog->GetTable(plan_->TableOid())->schema_, indexes[i]->key_schema_,
+                                   indexes[i]->index_->GetKeyAttrs()),
+          insert_rid);
     }
   }
+  // 插入index
+  for (size_t i = 0; i < indexes.size(); i++) {
+    indexes[i]->index_->InsertEntries(index_entries[i], nullptr);
+  }
   std::vector<Value> res{};
   res.emplace_back(TypeId::INTEGER, size);
   *tuple = Tuple{res, &GetOutputSchema()};
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "execution/executors/update_executor.h"
 
@@ -36,6 +38,8 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   RID child_rid;
   Tuple child_tuple;
   TupleMeta meta = {INVALID_TXN_ID, INVALID_TXN_ID, false};
+  // 每个index要插入的新数据，所有tuple更新之后再按key排序批量插入
+  std::vector<std::vector<std::pair<Tuple, RID>>> index_entries(indexes.size());
   while (child_executor_->Next(&child_tuple, &child_rid)) {
     // 删除旧数据
     TupleMeta old_meta = table->GetTupleMeta(child_rid);
@@ -58,15 +62,20 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
     }
     Tuple insert_tuple = Tuple(values, schema);
     RID insert_rid = table->InsertTuple(meta, insert_tuple, nullptr, nullptr, plan_->TableOid()).value();
-    // 插入index
-    for (IndexInfo *index_ptr : indexes) {
-      index_tuple = insert_tuple.KeyFromTuple(catalog->GetTable(plan_->TableOid())->schema_, index_ptr->key_schema_,
-                                              index_ptr->index_->GetKeyAttrs());
-      index_ptr->index_->InsertEntry(index_tuple, insert_rid, nullptr);
+    // 记录要插入index的数据
+    for (size_t i = 0; i < indexes.size(); i++) {
+      index_entries[i].emplace_back(
+          insert_tuple.KeyFromTuple(catalog->GetTable(plan_->TableOid())->schema_, indexes[i]->key_schema_,
+                                    indexes[i]->index_->GetKeyAttrs()),
+          insert_rid);
     }
     // 记录增加
     size++;
   }
+  // 插入index
+  for (size_t i = 0; i < indexes.size(); i++) {
+    indexes[i]->index_->InsertEntries(index_entries[i], nullptr);
+  }
   std::vector<Value> res{};
   res.emplace_back(TypeId::INTEGER, size);
   *tuple = Tuple{res, &GetOutputSchema()};
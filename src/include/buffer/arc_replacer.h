@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy of Megiddo and Modha.
+ *
+ * Resident frames are split between T1, frames accessed once since they were loaded, and T2, frames accessed at
+ * least twice. Both are LRU lists. The ids of pages evicted from T1 and T2 are remembered in the ghost lists B1 and
+ * B2. A miss on a page in B1 means T1 was too small and grows the target size p of T1, a miss on a page in B2 shrinks
+ * it, and eviction takes from T1 while it holds more than p frames. Pinned frames are skipped, so the target is a
+ * preference rather than a hard bound.
+ *
+ * Scan accesses never promote a frame to T2, and frames only touched by scans are not remembered in B1.
+ */
+class ArcReplacer : public Replacer {
+ public:
+  /**
+   * @brief a new ArcReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ArcReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ArcReplacer);
+
+  ~ArcReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void EvictFrame(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  /** @return the current target size of T1, exposed for tests */
+  auto GetTargetRecentSize() -> size_t;
+
+ private:
+  enum class ArcList { None = 0, T1, T2 };
+
+  struct ArcNode {
+    ArcList list_{ArcList::None};
+    size_t last_access_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool is_evictable_{false};
+    bool scan_only_{false};
+  };
+
+  /** @return the set holding the frame while it is evictable */
+  auto ListOf(const ArcNode &node) -> std::set<std::pair<size_t, frame_id_t>> & {
+    return node.list_ == ArcList::T1 ? t1_ : t2_;
+  }
+
+  /** Evict an evictable frame, remembering its page in B1 or B2. Requires latch_. */
+  void EvictLocked(frame_id_t frame_id);
+
+  /** Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c by forgetting the oldest ghosts. */
+  void TrimGhosts();
+
+  std::vector<ArcNode> node_store_;  // indexed by frame id
+  /** Evictable frames of T1 and T2 in LRU order. */
+  std::set<std::pair<size_t, frame_id_t>> t1_;
+  std::set<std::pair<size_t, frame_id_t>> t2_;
+  GhostList b1_;
+  GhostList b2_;
+  size_t t1_size_{0};  // tracked frames in T1, evictable or not
+  size_t t2_size_{0};  // tracked frames in T2, evictable or not
+  size_t p_{0};        // target size of T1
+  size_t capacity_;
+  size_t current_timestamp_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
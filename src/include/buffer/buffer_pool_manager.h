@@ -12,13 +12,27 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <memory>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/stats.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -26,8 +40,67 @@
 
 namespace bustub {
 
+/**
+ * The priority class of a buffer group. When a frame has to be reused, the buffer pool evicts a page of the lowest
+ * class that has an evictable page, following the replacement policy within that class.
+ */
+enum class BufferPriority { Low = 0, Normal, High };
+
+/** Parses a priority class name such as "low", "normal" or "high", ignoring case. */
+auto BufferPriorityFromString(const std::string &name) -> std::optional<BufferPriority>;
+
+/** @return the canonical name of the priority class */
+auto BufferPriorityToString(BufferPriority priority) -> std::string;
+
+/** The share of the buffer pool a buffer group is entitled to. */
+struct BufferQuota {
+  /**
+   * Frames the group keeps resident. Its pages are only evicted below this count when no other page can be. The
+   * reserve is split evenly over the partitions of the buffer pool.
+   */
+  size_t min_frames_{0};
+  /** The priority class of the pages of the group above the reserve. */
+  BufferPriority priority_{BufferPriority::Normal};
+};
+
+/**
+ * A reading of the statistics of a BufferPoolManager, summed over all threads since construction or the last
+ * ResetStats.
+ */
+struct BufferPoolStats {
+  /** FetchPage calls that found the page in the buffer pool. */
+  uint64_t hits_{0};
+  /** FetchPage calls that read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty victims written back by the thread that evicted them. */
+  uint64_t dirty_writebacks_{0};
+  /** Dirty pages written back ahead of eviction by the background flusher. */
+  uint64_t flusher_writes_{0};
+  /** Times a thread blocked until another thread finished reading or writing a frame. */
+  uint64_t io_waits_{0};
+  /** FetchPage/NewPage calls that failed because every frame was pinned. */
+  uint64_t no_free_frame_{0};
+  /** Pages created by NewPage. */
+  uint64_t new_pages_{0};
+  /** Reads scheduled by PrefetchPage. */
+  uint64_t prefetches_{0};
+  /** Latency of FetchPage calls that missed, including the write back of a dirty victim. */
+  LatencyHistogram miss_latency_;
+  /** Time spent blocked on the I/O of another thread. */
+  LatencyHistogram io_wait_latency_;
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Fetching a page that is already in the buffer pool and unpinning a page that stays pinned, or that the replacer
+ * already considers evictable, do not take any latch: the page table can be read without the latch, pins are taken
+ * with compare-and-swap on the pin count, and the accesses are buffered and handed to the replacer the next time the
+ * partition latch is taken. A frame is claimed with compare-and-swap from a pin count of zero before it is reused, so
+ * the replacer may pick a frame that has been pinned without the latch; such a frame is made non-evictable and the
+ * next one is tried.
  */
 class BufferPoolManager {
  public:
@@ -37,9 +110,13 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param num_partitions the number of independent partitions the frames are split into. Each partition has its own
+   * page table, free list, replacer and latch, and every page id is owned by exactly one partition.
+   * @param replacer_policy the replacement policy used by every partition
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, size_t num_partitions = 1,
+                    ReplacerPolicy replacer_policy = ReplacerPolicy::LRUK);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
@@ -49,8 +126,44 @@ class BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  /**
+   * @brief Return a frame of the buffer pool. Frames are numbered partition by partition.
+   * @param frame_index a frame index smaller than GetPoolSize()
+   */
+  auto GetFrame(size_t frame_index) -> Page *;
+
+  /** @brief Return the number of allocated frames whose data is backed by huge pages. */
+  auto HugePageFrames() -> size_t;
+
+  /**
+   * @brief Grow or shrink the buffer pool to a new number of frames, spread over the partitions like in the
+   * constructor. Growing allocates new chunks of frames; the existing frames are not moved. Shrinking evicts the pages
+   * of the frames that go away, writing back the dirty ones, and waits up to `bpm_resize_timeout` for pinned frames to
+   * be unpinned. Frames that go away keep their book-keeping information, so that threads looking them up without the
+   * latch stay safe, but their page data is freed.
+   *
+   * Must not be called concurrently with itself or with SetReplacerPolicy.
+   *
+   * @param pool_size the new number of frames, at least the number of partitions
+   * @return false if some frames stayed pinned and the buffer pool could not shrink to the requested size
+   */
+  auto Resize(size_t pool_size) -> bool;
+
+  /** @brief Return the number of partitions the buffer pool is split into. */
+  auto GetNumPartitions() -> size_t { return partitions_.size(); }
+
+  /** @brief Return the replacement policy currently in use. */
+  auto GetReplacerPolicy() -> ReplacerPolicy { return replacer_policy_; }
+
+  /**
+   * @brief Switch every partition to a new replacement policy. The resident pages stay in the buffer pool, but their
+   * access history is lost: each one is handed to the new replacer as if it had just been accessed once.
+   *
+   * Must not be called concurrently with itself.
+   *
+   * @param replacer_policy the new replacement policy
+   */
+  void SetReplacerPolicy(ReplacerPolicy replacer_policy);
 
   /**
    *
@@ -71,13 +184,10 @@ class BufferPoolManager {
   auto NewPage(page_id_t *page_id) -> Page *;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief PageGuard wrapper for NewPage
    *
-   * Functionality should be the same as NewPage, except that
-   * instead of returning a pointer to a page, you return a
-   * BasicPageGuard structure.
+   * Creates a page like NewPage and returns it in a BasicPageGuard, which unpins it when dropped. The guard is empty
+   * if every frame is pinned.
    *
    * @param[out] page_id, the id of the new page
    * @return BasicPageGuard holding a new page
@@ -97,27 +207,43 @@ class BufferPoolManager {
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page. Pages fetched with AccessType::Scan are kept at the cold end of
+   * the replacer so that sequential scans do not push out the pages used by point lookups.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
   auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief PageGuard wrappers for FetchPage
    *
-   * Functionality should be the same as FetchPage, except
-   * that, depending on the function called, a guard is returned.
-   * If FetchPageRead or FetchPageWrite is called, it is expected that
-   * the returned page already has a read or write latch held, respectively.
+   * Fetch the page like FetchPage and return it in a guard that unpins it when dropped. FetchPageBasic only pins the
+   * page. FetchPageRead and FetchPageWrite return it with the read or write latch held. FetchPageUpgradable returns it
+   * with the upgrade latch held, which can later be turned into the write latch.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type, the access hint forwarded to FetchPage
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+  auto FetchPageUpgradable(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> UpgradablePageGuard;
+
+  /**
+   * @brief Find a resident page for an optimistic read without pinning it or recording the access, so that the read
+   * writes no shared state. The frame may be reused for another page at any time, so the data read from it is only
+   * valid if ValidateOptimistic holds afterwards.
+   *
+   * @param page_id id of the page
+   * @param[out] version the version to pass to ValidateOptimistic
+   * @return the page, or nullptr if it is not resident, is being read from disk or is write latched
+   */
+  auto ReadPageOptimistic(page_id_t page_id, uint64_t *version) -> const Page *;
+
+  /**
+   * @brief Check that a page returned by ReadPageOptimistic still holds the same page and was not written since.
+   */
+  auto ValidateOptimistic(const Page *page, page_id_t page_id, uint64_t version) -> bool;
 
   /**
    *
@@ -129,11 +255,21 @@ class BufferPoolManager {
    *
    * @param page_id id of page to be unpinned
    * @param is_dirty true if the page should be marked as dirty, false otherwise
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page. Unused: the replacement decision is made when the page is fetched.
    * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
    */
   auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
+  /**
+   * @brief Unpin a page the caller has pinned, see UnpinPage. The page table lookup is skipped, so this is what page
+   * guards use when they are dropped.
+   *
+   * @param page a page returned by FetchPage or NewPage and not unpinned yet
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page is not pinned, true otherwise
+   */
+  auto ReleasePage(Page *page, bool is_dirty) -> bool;
+
   /**
    *
    * @brief Flush the target page to disk.
@@ -148,57 +284,448 @@ class BufferPoolManager {
 
   /**
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the dirty pages in the buffer pool to disk.
+   *
+   * The dirty pages of every partition are collected first and sorted by page id, so that each run of contiguous pages
+   * is written with a single vectored write. The disk manager is synced once at the end.
    */
   void FlushAllPages();
 
   /**
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, only free it on disk and return
+   * true. If the page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, call DeallocatePage() so that the page
+   * id can be reused by a later NewPage.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePage(page_id_t page_id) -> bool;
 
+  /**
+   * @brief Delete a page once its last pin is released, for a page that DeletePage could not delete because it is
+   * pinned. The page must no longer be reachable, so that only pins taken before it was unlinked remain. Until then
+   * the frame stays non-evictable, and the page id is freed when the frame is.
+   *
+   * @param page_id id of page to be deleted
+   */
+  void DeferDeletePage(page_id_t page_id);
+
+  /**
+   * @brief Start the background flusher thread. It wakes up every `bpm_flusher_interval` and writes back dirty,
+   * unpinned pages in eviction order whenever a partition runs low on frames that can be reused without a write, so
+   * that threads fetching pages rarely have to write back a dirty victim themselves. The watermarks and the rate are
+   * configured in `common/config.h`.
+   *
+   * When logging is enabled, a page is not written back before the log records up to its LSN are persistent.
+   */
+  void StartBackgroundFlusher();
+
+  /** @brief Stop the background flusher thread, if it is running. */
+  void StopBackgroundFlusher();
+
+  /**
+   * @brief Schedule an asynchronous read of a page into the buffer pool, without pinning it. The read goes into a
+   * free frame or replaces a clean unpinned page; dirty pages are never written back to make room for a prefetch.
+   * The page enters the replacer like a page touched by a scan, so it is evicted early if nobody fetches it.
+   *
+   * A later FetchPage of the page waits for the read to complete instead of issuing its own.
+   *
+   * @param page_id id of the page to read, INVALID_PAGE_ID is ignored
+   * @return true if a read was scheduled, false if the page is already in the buffer pool or there is no clean frame
+   */
+  auto PrefetchPage(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Schedule asynchronous reads of several pages, see PrefetchPage.
+   * @return the number of reads scheduled
+   */
+  auto PrefetchPages(const std::vector<page_id_t> &page_ids) -> size_t;
+
+  /**
+   * @brief Write the ids of the resident pages to a warm-up file, hottest first according to the replacers. The file
+   * is written next to `path` and renamed over it, so a crash never leaves a torn file behind.
+   * @return the number of page ids written
+   */
+  auto DumpResidentPages(const std::string &path) -> size_t;
+
+  /**
+   * @brief Preload the pages listed in a warm-up file written by DumpResidentPages. The hottest pages that fit into
+   * the free frames are claimed right away and read in the background, sorted by page id and merged into vectored
+   * reads, so queries can run during the warm-up; a fetch of a page still being read waits for that read. Page ids
+   * that are free on disk are skipped.
+   * @return the number of pages scheduled, 0 if the file does not exist or is not a warm-up file
+   */
+  auto WarmUp(const std::string &path) -> size_t;
+
+  /**
+   * @brief Keep a warm-up file up to date: the background flusher rewrites it every `bpm_warmup_dump_interval` and the
+   * destructor writes it a last time. Call before StartBackgroundFlusher.
+   */
+  void SetWarmUpFile(const std::string &path) { warmup_file_ = path; }
+
+  /**
+   * @brief Check whether a page is in the buffer pool and can be fetched without waiting for disk I/O. This is only a
+   * hint: the page may be evicted right after the call.
+   */
+  auto IsPageCached(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Read the statistics of the buffer pool. Counters are updated without locks from every thread, so the
+   * reading is not an atomic snapshot while the buffer pool is in use.
+   */
+  auto GetStats() const -> BufferPoolStats;
+
+  /** @brief Set every statistic back to zero. */
+  void ResetStats();
+
+  /**
+   * @brief Create a buffer group, a set of pages sharing a BufferQuota such as the pages of one table or index. A new
+   * group has the default quota: no reserve and Normal priority.
+   */
+  auto CreateBufferGroup() -> buffer_group_t;
+
+  /** @brief Set the quota of a buffer group, effective for the next eviction. */
+  void SetBufferQuota(buffer_group_t group, const BufferQuota &quota);
+
+  /** @brief Return the quota of a buffer group. */
+  auto GetBufferQuota(buffer_group_t group) -> BufferQuota;
+
+  /**
+   * @brief Place a page in a buffer group, whether it is resident or not. The page stays in the group until it is
+   * deleted or placed in another group. Pages start in DEFAULT_BUFFER_GROUP.
+   */
+  void SetPageGroup(page_id_t page_id, buffer_group_t group);
+
+  /** @brief Return the number of frames holding a page of a buffer group. DEFAULT_BUFFER_GROUP is not counted. */
+  auto GetResidentFrames(buffer_group_t group) -> size_t;
+
+  /** @brief Return the compressed page cache below the buffer pool, or nullptr if it is disabled. */
+  auto GetCompressedCache() -> CompressedPageCache * { return compressed_cache_.get(); }
+
  private:
+  /**
+   * A partition is an independent slice of the buffer pool. It owns a contiguous range of frames and the pages whose
+   * id hashes to it, so operations on pages living in different partitions never contend on the same latch.
+   *
+   * Frame ids stored in the page table, the free list and the replacer are local to the partition.
+   */
+  struct Partition {
+    Partition(page_id_t next_page_id, size_t pool_size, size_t replacer_k, ReplacerPolicy replacer_policy);
+    ~Partition();
+
+    /** Maximum number of frame chunks of a partition; chunk i holds BPM_FRAME_CHUNK_SIZE * 2^i frames. */
+    static constexpr size_t MAX_FRAME_CHUNKS = 24;
+
+    /**
+     * The frames of one chunk, with the I/O state of each frame. Never freed before the partition. The page data is in
+     * an arena of its own, the Page objects only hold the book-keeping information and point into the arena.
+     */
+    struct FrameChunk {
+      explicit FrameChunk(size_t size)
+          : arena_(size), pages_(new Page[size]), io_in_progress_(new std::atomic<bool>[size]),
+            io_done_(new std::condition_variable[size]) {}
+      FrameArena arena_;
+      std::unique_ptr<Page[]> pages_;
+      /**
+       * Per-frame flag, true while the frame is written back or read from disk without the latch held. Such a frame
+       * is always pinned, and its data must not be used until the flag is cleared.
+       */
+      std::unique_ptr<std::atomic<bool>[]> io_in_progress_;
+      /** Per-frame condition variable, notified when the I/O in progress on that frame completes. */
+      std::unique_ptr<std::condition_variable[]> io_done_;
+    };
+
+    /** @return the chunk holding a frame and the index of the frame inside it */
+    static auto ChunkOf(frame_id_t frame_id) -> std::pair<size_t, size_t> {
+      auto i = static_cast<uint64_t>(frame_id) + BPM_FRAME_CHUNK_SIZE;
+      size_t chunk = 63 - __builtin_clzll(i) - __builtin_ctzll(BPM_FRAME_CHUNK_SIZE);
+      return {chunk, i - (static_cast<uint64_t>(BPM_FRAME_CHUNK_SIZE) << chunk)};
+    }
+
+    auto GetPage(frame_id_t frame_id) -> Page & {
+      auto [chunk, index] = ChunkOf(frame_id);
+      return chunks_[chunk].load(std::memory_order_acquire)->pages_[index];
+    }
+    /** Give the memory of a frame back to the operating system, the frame reads as zeros when it is used again. */
+    void DiscardFrame(frame_id_t frame_id) {
+      auto [chunk, index] = ChunkOf(frame_id);
+      chunks_[chunk].load(std::memory_order_acquire)->arena_.Discard(index);
+    }
+    auto IOInProgress(frame_id_t frame_id) -> std::atomic<bool> & {
+      auto [chunk, index] = ChunkOf(frame_id);
+      return chunks_[chunk].load(std::memory_order_acquire)->io_in_progress_[index];
+    }
+    auto IODone(frame_id_t frame_id) -> std::condition_variable & {
+      auto [chunk, index] = ChunkOf(frame_id);
+      return chunks_[chunk].load(std::memory_order_acquire)->io_done_[index];
+    }
+    /** @return the current page table, which may be read without the latch */
+    auto Table() -> PageTable & { return *page_table_.load(std::memory_order_acquire); }
+
+    /**
+     * Add frames [pool_size_, pool_size) to the free list, allocating chunks as needed, and grow the page table if it
+     * is too small. Caller should acquire the latch.
+     */
+    void AddFrames(size_t pool_size);
+
+    /** Number of frames in this partition, frame ids are [0, pool_size_). */
+    size_t pool_size_{0};
+    /** While shrinking, frames at or above this id are not handed out from the free list. */
+    size_t usable_size_{0};
+    /** Chunks allocated so far, published with release so that lock-free readers can find new frames. */
+    std::array<std::atomic<FrameChunk *>, MAX_FRAME_CHUNKS> chunks_{};
+    /** The next page id to be allocated by this partition. Page ids are striped across partitions. */
+    page_id_t next_page_id_;
+    /** Page table for keeping track of the pages in this partition. Modified under the latch, read without it. */
+    std::atomic<PageTable *> page_table_{nullptr};
+    /** The current page table is the last one; the others are kept alive for lock-free readers still using them. */
+    std::vector<std::unique_ptr<PageTable>> page_tables_;
+    /** Replacer to find unpinned pages for replacement. */
+    std::unique_ptr<Replacer> replacer_;
+    /** List of free frames that don't have any pages on them. */
+    std::list<frame_id_t> free_list_;
+    /** Dirty pages evicted from this partition that are still being written back, mapped to the frame doing it. */
+    std::unordered_map<page_id_t, frame_id_t> writeback_table_;
+    /** Pages passed to DeferDeletePage that are still pinned. Their frames are non-evictable until they are freed. */
+    std::unordered_set<page_id_t> pending_deletes_;
+    /**
+     * Accesses of lock-free page hits that have not been recorded in the replacer yet, a ring of packed
+     * (page id, frame id, access type) entries with 0 for a slot that is not written yet. Any thread appends, the
+     * holder of the latch drains.
+     */
+    std::unique_ptr<std::atomic<uint64_t>[]> access_buffer_;
+    std::atomic<uint64_t> access_head_{0};
+    std::atomic<uint64_t> access_tail_{0};
+    /** Quota and residency of a buffer group within this partition. */
+    struct GroupState {
+      /** The share of the reserve of the group this partition keeps. */
+      size_t reserved_frames_{0};
+      BufferPriority priority_{BufferPriority::Normal};
+      size_t resident_frames_{0};
+    };
+    /** Groups of the pages of this partition that are not in DEFAULT_BUFFER_GROUP, resident or not. */
+    std::unordered_map<page_id_t, buffer_group_t> page_groups_;
+    /** Indexed by group id, grown as groups are used. */
+    std::vector<GroupState> groups_;
+    /** True if a group has a reserve or a priority other than Normal, victims are then chosen by SelectVictim. */
+    bool has_quotas_{false};
+    /** Protects every other member and the metadata of every frame in this partition. */
+    std::mutex latch_;
+  };
+
   /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
+  std::atomic<size_t> pool_size_;
+  /** The lookback constant of the LRU-K policy, kept to rebuild the replacers when the policy changes. */
+  const size_t replacer_k_;
+  /** The replacement policy of every partition. */
+  std::atomic<ReplacerPolicy> replacer_policy_;
+  /** Partition to start searching from in NewPage, so that new pages are spread over all partitions. */
+  std::atomic<size_t> next_partition_ = 0;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;
-  /** List of free frames that don't have any pages on them. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
-
-  /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+  DiskManager *disk_manager_;
+  /** Pointer to the log manager. Dirty pages are not written back before their log records are persisted. */
+  LogManager *log_manager_;
+  /** The next id CreateBufferGroup hands out. */
+  std::atomic<buffer_group_t> next_buffer_group_{DEFAULT_BUFFER_GROUP + 1};
+  /** The quotas set with SetBufferQuota, protected by quota_latch_. */
+  std::unordered_map<buffer_group_t, BufferQuota> quotas_;
+  std::mutex quota_latch_;
+  /** Second cache tier holding evicted pages compressed, nullptr if bpm_compressed_cache_size is 0. */
+  std::unique_ptr<CompressedPageCache> compressed_cache_;
+  /** The partitions of the buffer pool. The set of partitions is immutable after construction. */
+  std::vector<std::unique_ptr<Partition>> partitions_;
+  /** A read scheduled by PrefetchPage, performed by the prefetch thread. */
+  struct PrefetchRequest {
+    Partition *part_;
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+  /** Reads waiting for the prefetch thread, protected by prefetch_latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool stop_prefetch_{false};
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  /** Started by the first PrefetchPage call. */
+  std::thread prefetch_thread_;
+  /** Warm-up file kept up to date by the background flusher and the destructor, empty if none. */
+  std::string warmup_file_;
+
+  /** @brief The loop of the prefetch thread. It drains the queue before exiting. */
+  void RunPrefetch();
+
+  enum class StatCounter {
+    Hits,
+    Misses,
+    Evictions,
+    DirtyWritebacks,
+    FlusherWrites,
+    IOWaits,
+    NoFreeFrame,
+    NewPages,
+    Prefetches,
+    Count
+  };
+  enum class StatHistogram { MissLatency, IOWaitLatency, Count };
+  using Stats = ShardedStats<static_cast<size_t>(StatCounter::Count), static_cast<size_t>(StatHistogram::Count)>;
+  /** Statistics of the buffer pool, sharded per thread. */
+  Stats stats_;
+  void CountStat(StatCounter counter, uint64_t delta = 1) { stats_.Add(static_cast<size_t>(counter), delta); }
+
+  /** True while the background flusher should keep running. */
+  std::atomic<bool> enable_background_flusher_{false};
+  std::thread background_flusher_thread_;
+
+  /** @brief The loop of the background flusher thread. */
+  void RunBackgroundFlusher();
+
+  /**
+   * @brief Write back dirty, unpinned pages of a partition, in eviction order, if its number of reusable frames is
+   * below the low watermark.
+   * @return the number of pages written
+   */
+  auto CleanPartition(Partition &part) -> size_t;
+
+  /** @return the partition that owns the given page id */
+  auto GetPartition(page_id_t page_id) -> Partition & { return *partitions_[page_id % partitions_.size()]; }
+
+  /**
+   * @brief Create a new page in the given partition. The partition latch must be held through `lock`; it is released
+   * while a dirty victim is written back.
+   * @return nullptr if every frame of the partition is pinned, otherwise pointer to new page
+   */
+  auto NewPageInPartition(Partition &part, std::unique_lock<std::mutex> &lock, page_id_t *page_id) -> Page *;
+
+  /**
+   * @brief Pick a replacement frame from the free list or the replacer of the partition. If the old page is dirty, or
+   * any page when the compressed page cache is enabled, it is registered in the writeback table and the caller must
+   * hand it to EvictPage, without the latch, before reusing the frame. Caller should acquire the partition latch.
+   * @param[out] frame_id the frame that can be reused
+   * @param[out] victim_page_id the page to write back from the frame, or INVALID_PAGE_ID
+   * @return false if every frame of the partition is pinned
+   */
+  auto AcquireFrame(Partition &part, frame_id_t *frame_id, page_id_t *victim_page_id) -> bool;
+
+  /**
+   * @brief Pin a resident page without the partition latch.
+   * @return the page, or nullptr if the page has to be fetched through the latched path
+   */
+  auto TryPinFast(Partition &part, page_id_t page_id, AccessType access_type) -> Page *;
+
+  /** @brief Drop one pin of a frame, without the latch unless the frame has to become evictable. */
+  void ReleasePin(Partition &part, frame_id_t frame_id);
+
+  /**
+   * @brief Drop one pin of a frame. If it was the last pin of a page waiting in pending_deletes_, delete the page.
+   * Caller should acquire the partition latch.
+   */
+  void ReleasePinLocked(Partition &part, frame_id_t frame_id);
+
+  /**
+   * @brief Wait until no read or write-back of a page is in progress, so that the page can be deleted.
+   * @return true and the frame of the page if it is resident, false if it is not
+   */
+  auto FindFrameForDelete(Partition &part, std::unique_lock<std::mutex> &lock, page_id_t page_id, frame_id_t *frame_id)
+      -> bool;
+
+  /**
+   * @brief Drop a deleted page from a claimed frame, put the frame on the free list and free the page id. Caller
+   * should acquire the partition latch.
+   */
+  void FreeFrame(Partition &part, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Pick the next victim and evict it from the replacer. Without quotas this is the choice of the replacer;
+   * with quotas it is the first of the next BPM_QUOTA_EVICTION_PEEK eviction candidates with the lowest rank, see
+   * EvictionRank. Caller should acquire the partition latch.
+   * @return false if no frame is evictable
+   */
+  auto SelectVictim(Partition &part, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Rank a resident page for eviction: its priority class, or one above High if its group is within its
+   * reserve. Lower ranks are evicted first. Caller should acquire the partition latch.
+   */
+  static auto EvictionRank(Partition &part, const Page &page) -> int;
+
+  /** @brief Return the state of a group in a partition, growing the group table if needed. */
+  static auto GroupOf(Partition &part, buffer_group_t group) -> Partition::GroupState &;
+
+  /** @brief Stop counting a frame that loses its page as resident in the group of the page. */
+  static void DetachFrameGroup(Partition &part, Page &page);
+
+  /**
+   * @brief Make a claimed frame hold `page_id` with the given pin count and hand it to the replacer. Caller should
+   * acquire the partition latch.
+   */
+  void PublishFrame(Partition &part, frame_id_t frame_id, page_id_t page_id, int pin_count, AccessType access_type,
+                    bool evictable);
+
+  /** @brief Queue the access of a lock-free page hit for the replacer. */
+  void RecordAccessDeferred(Partition &part, frame_id_t frame_id, page_id_t page_id, AccessType access_type);
+
+  /** @brief Hand the queued accesses to the replacer. Caller should acquire the partition latch. */
+  void DrainAccesses(Partition &part);
+
+  /** @brief Take a frame below usable_size_ from the free list. Caller should acquire the partition latch. */
+  auto PopFreeFrame(Partition &part, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Shrink a partition, see Resize. Caller should hold the partition latch through `lock`; it is released while
+   * waiting for pinned frames and while dirty pages are written back.
+   * @return false if frames stayed pinned past the timeout
+   */
+  auto ShrinkPartition(Partition &part, std::unique_lock<std::mutex> &lock, size_t pool_size) -> bool;
+
+  /**
+   * @brief Replace the replacer of a partition, handing it the resident pages. Caller should acquire the latch.
+   */
+  void RebuildReplacer(Partition &part, ReplacerPolicy replacer_policy);
+
+  /**
+   * @brief Write back a victim page: into the compressed page cache if it is enabled, otherwise to disk if it is dirty.
+   * Called without the latch.
+   */
+  void EvictPage(page_id_t page_id, const char *page_data, bool is_dirty);
+
+  /**
+   * @brief Read a page into a frame, from the compressed page cache if it holds the page, otherwise from disk. Called
+   * without the latch while the frame is marked as in I/O.
+   */
+  void ReadPageData(page_id_t page_id, Page *page);
+
+  /**
+   * @brief Claim a frame for a read scheduled without pinning, see PrefetchPage, and publish it as not evictable with
+   * I/O in progress. Caller should acquire the partition latch.
+   * @return false if the page is already in the partition or there is no clean frame
+   */
+  auto ClaimPrefetchFrame(Partition &part, page_id_t page_id, AccessType access_type, frame_id_t *frame_id) -> bool;
+
+  /** @brief Hand claimed frames to the prefetch thread. */
+  void SchedulePrefetch(const std::vector<PrefetchRequest> &requests);
+
+  /** @brief Block on `lock` until no I/O is in progress on the frame. */
+  void WaitForFrameIO(Partition &part, std::unique_lock<std::mutex> &lock, frame_id_t frame_id);
+
+  /** @brief Mark the I/O on the frame as complete and wake up its waiters. Caller should acquire the latch. */
+  void FinishFrameIO(Partition &part, frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * @brief Allocate a page on disk. The lowest free page owned by the partition is reused first; otherwise a new page
+   * id is taken. Caller should acquire the partition latch before calling this function.
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(Partition &part) -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk by handing it to the free page map of the disk manager. Caller should acquire the
+   * partition latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(Partition &part, page_id_t page_id);
 };
 }  // namespace bustub
@@ -12,17 +12,21 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Tracked frames sit on a circular buffer indexed by frame id. Every access sets the reference bit of the frame, and
+ * the clock hand sweeps the buffer, clearing reference bits until it reaches an evictable frame whose bit is already
+ * clear. A scan access does not set the reference bit, so frames brought in by scans are evicted on the next sweep.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +36,37 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  struct ClockSlot {
+    bool is_tracked_{false};
+    bool is_evictable_{false};
+    bool ref_{false};
+  };
+
+  std::vector<ClockSlot> slots_;  // indexed by frame id
+  size_t hand_{0};
+  size_t evictable_size_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
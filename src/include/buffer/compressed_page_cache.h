@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * A reading of the statistics of a CompressedPageCache.
+ */
+struct CompressedPageCacheStats {
+  /** Take calls that found the page. */
+  uint64_t hits_{0};
+  /** Take calls that did not find the page, the caller reads it from disk. */
+  uint64_t misses_{0};
+  /** Pages dropped to stay within the capacity. */
+  uint64_t evictions_{0};
+  /** Dropped pages that were dirty and had to be written to disk. */
+  uint64_t writebacks_{0};
+  /** Pages currently held. */
+  uint64_t pages_{0};
+  /** Bytes currently used by the compressed pages. */
+  uint64_t compressed_bytes_{0};
+
+  /** @return the fraction of Take calls that found the page, 0 if there was none */
+  auto HitRate() const -> double { return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / (hits_ + misses_); }
+
+  /** @return the uncompressed size of the held pages divided by their compressed size, 0 if the cache is empty */
+  auto CompressionRatio() const -> double {
+    return compressed_bytes_ == 0 ? 0 : static_cast<double>(pages_ * BUSTUB_PAGE_SIZE) / compressed_bytes_;
+  }
+};
+
+/**
+ * CompressedPageCache is a second cache tier between the buffer pool and the disk manager. The buffer pool hands it
+ * the pages it evicts, clean or dirty, and it keeps them LZF-compressed in memory, so that a working set somewhat
+ * larger than the buffer pool is served without disk I/O. The cache is exclusive: Take removes the page, which then
+ * lives in the buffer pool only. When the cache is over its capacity it drops the least recently stored pages,
+ * writing the dirty ones to disk.
+ *
+ * The pages are spread over shards by page id, each with its own latch and LRU list. A page that has to be written
+ * back is written while its shard latch is held, so a concurrent Take of that page waits and then reads it from disk.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * @param disk_manager the disk manager dirty pages are written back to
+   * @param capacity the maximum number of bytes of compressed data to hold
+   */
+  CompressedPageCache(DiskManager *disk_manager, size_t capacity);
+
+  /**
+   * Store an evicted page, replacing any older copy.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param is_dirty true if the page differs from its copy on disk
+   */
+  void Put(page_id_t page_id, const char *page_data, bool is_dirty);
+
+  /**
+   * Move a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param[out] is_dirty true if the page still has to be written to disk
+   * @return true if the page was cached
+   */
+  auto Take(page_id_t page_id, char *page_data, bool *is_dirty) -> bool;
+
+  /** @return true if the page is cached */
+  auto Contains(page_id_t page_id) -> bool;
+
+  /** Drop a page without writing it back, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /**
+   * Write every dirty page to disk. The pages stay cached as clean pages.
+   * @return the number of pages written
+   */
+  auto Flush() -> size_t;
+
+  /** @return the counters of this cache */
+  auto GetStats() const -> CompressedPageCacheStats;
+
+  /** Reset the hit, miss, eviction and writeback counters to zero. */
+  void ResetStats();
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+
+  struct Entry {
+    page_id_t page_id_;
+    bool is_dirty_;
+    /** 0 if the page did not compress and is stored as is. */
+    size_t compressed_size_;
+    std::unique_ptr<char[]> data_;
+
+    auto Size() const -> size_t { return compressed_size_ == 0 ? BUSTUB_PAGE_SIZE : compressed_size_; }
+  };
+
+  struct Shard {
+    std::mutex latch_;
+    /** Most recently stored page first. */
+    std::list<Entry> lru_;
+    std::unordered_map<page_id_t, std::list<Entry>::iterator> entries_;
+    size_t bytes_{0};
+  };
+
+  auto ShardOf(page_id_t page_id) -> Shard & { return shards_[static_cast<uint32_t>(page_id) % NUM_SHARDS]; }
+
+  /** Decompress an entry into a page buffer. */
+  static void Decode(const Entry &entry, char *page_data);
+
+  /** Remove an entry from its shard. Requires the shard latch. */
+  void RemoveEntry(Shard &shard, std::list<Entry>::iterator it);
+
+  DiskManager *disk_manager_;
+  size_t shard_capacity_;
+  std::array<Shard, NUM_SHARDS> shards_;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> writebacks_{0};
+  std::atomic<uint64_t> pages_{0};
+  std::atomic<uint64_t> compressed_bytes_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** What backs the memory of a FrameArena. */
+enum class FrameArenaBacking {
+  /** Regular pages of the operating system. */
+  Pages,
+  /** Regular pages, with the kernel asked to promote them to transparent huge pages. */
+  TransparentHugePages,
+  /** Huge pages reserved from the hugetlb pool. */
+  HugeTlb,
+};
+
+auto FrameArenaBackingToString(FrameArenaBacking backing) -> std::string;
+
+/**
+ * FrameArena holds the data of a run of buffer pool frames in a single anonymous memory mapping. Every frame starts
+ * on a BUSTUB_PAGE_SIZE boundary, so frames can be read and written with direct I/O, and the frames of a large arena
+ * are mapped with huge pages when possible, which saves most of the TLB misses of scanning a large buffer pool.
+ *
+ * With huge pages enabled, an arena of at least one huge page first asks for MAP_HUGETLB pages, then falls back to
+ * regular pages advised with MADV_HUGEPAGE. A fresh arena reads as zeros and is only backed by memory as it is used.
+ *
+ * In AddressSanitizer builds every frame is followed by a poisoned guard page, so that writing past the end of a
+ * page is still reported as it was when every frame had its own heap allocation.
+ */
+class FrameArena {
+ public:
+  /**
+   * Map the memory of an arena. Throws an Exception if the memory cannot be mapped.
+   * @param num_frames number of frames in the arena
+   * @param use_huge_pages try to back the arena with huge pages
+   */
+  explicit FrameArena(size_t num_frames, bool use_huge_pages = bpm_use_huge_pages);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  auto operator=(const FrameArena &) -> FrameArena & = delete;
+
+  /** @return the data of a frame, BUSTUB_PAGE_SIZE bytes aligned to BUSTUB_PAGE_SIZE */
+  auto GetFrame(size_t index) const -> char * { return base_ + index * stride_; }
+
+  /** Give the memory of a frame back to the operating system. The frame reads as zeros afterwards. */
+  void Discard(size_t index);
+
+  /** @return the number of frames in the arena */
+  auto NumFrames() const -> size_t { return num_frames_; }
+
+  /** @return what backs the memory of the arena */
+  auto Backing() const -> FrameArenaBacking { return backing_; }
+
+ private:
+  /** Map anonymous memory starting at a multiple of alignment. @return the memory, or nullptr if mmap failed */
+  static auto MapAligned(size_t size, size_t alignment) -> char *;
+
+  /** @return the size of the huge pages of the system, if the system has any */
+  static auto HugePageSize() -> std::optional<size_t>;
+
+  char *base_{nullptr};
+  size_t mapped_size_{0};
+  size_t num_frames_;
+  /** Distance between two frames, one page, or two pages with the AddressSanitizer guard page. */
+  size_t stride_;
+  FrameArenaBacking backing_{FrameArenaBacking::Pages};
+};
+
+}  // namespace bustub
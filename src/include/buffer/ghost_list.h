@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages, without their data, in LRU order. It is used by the 2Q and
+ * ARC replacers to recognize pages that come back shortly after being evicted.
+ */
+class GhostList {
+ public:
+  /** @return true if the page is remembered, removing it from the list */
+  auto Take(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  /** Remember a page as the most recently evicted one. */
+  void Push(page_id_t page_id) {
+    Take(page_id);
+    pages_.push_front(page_id);
+    index_[page_id] = pages_.begin();
+  }
+
+  /** Forget the least recently evicted page, if any. */
+  void PopOldest() {
+    if (!pages_.empty()) {
+      index_.erase(pages_.back());
+      pages_.pop_back();
+    }
+  }
+
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+
+  auto Size() const -> size_t { return pages_.size(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -12,45 +12,65 @@
 
 #pragma once
 
-#include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
+/**
+ * LRUKNode keeps the replacement metadata of one frame. The last k access timestamps of the frame live in a ring
+ * buffer owned by LRUKReplacer; the node only remembers where the ring starts and how full it is.
+ */
 class LRUKNode {
  public:
-  LRUKNode() = default;  // 添加默认构造函数
-  explicit LRUKNode(size_t k, frame_id_t fid) {
-    k_ = k;
-    fid_ = fid;
-  }
+  LRUKNode() = default;
 
   auto IsEvictable() const -> bool { return is_evictable_; }
-  void SetIsEvictable(bool isEvictable) { is_evictable_ = isEvictable; }
-  auto GetHistory() -> const std::list<size_t> & { return history_; }
-  void AddHistory(size_t timestamp) {
-    if (history_.size() >= k_) {
-      history_.pop_back();
+  void SetIsEvictable(bool is_evictable) { is_evictable_ = is_evictable; }
+
+  /** @return the number of recorded timestamps, at most k */
+  auto GetHistorySize() const -> size_t { return history_size_; }
+
+  /** @return true if the frame is tracked by the replacer, i.e. it has been accessed at least once */
+  auto IsTracked() const -> bool { return history_size_ > 0; }
+
+  /** @return true if every access the frame has received so far was a sequential scan */
+  auto IsScanOnly() const -> bool { return scan_only_; }
+  void SetScanOnly(bool scan_only) { scan_only_ = scan_only; }
+
+  /** @return the position of the oldest timestamp inside the frame's ring buffer */
+  auto GetOldest() const -> size_t { return oldest_; }
+
+  /** Record one more timestamp in a ring buffer of size k, overwriting the oldest one if it is full. */
+  void AddHistory(size_t *ring, size_t k, size_t timestamp) {
+    if (history_size_ < k) {
+      ring[(oldest_ + history_size_) % k] = timestamp;
+      history_size_++;
+    } else {
+      ring[oldest_] = timestamp;
+      oldest_ = (oldest_ + 1) % k;
     }
-    history_.push_front(timestamp);
   }
 
- private:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
+  /** Forget the access history of the frame. */
+  void Reset() {
+    history_size_ = 0;
+    oldest_ = 0;
+    is_evictable_ = false;
+    scan_only_ = false;
+  }
 
-  std::list<size_t> history_;  // history是一个大小不超过k的队列，它的back表示前k次的时间戳，front表示上一次访问的时间戳
-  size_t k_;
-  frame_id_t fid_;
+ private:
+  size_t history_size_{0};
+  size_t oldest_{0};
   bool is_evictable_{false};
+  bool scan_only_{false};
 };
 
 /**
@@ -63,8 +83,18 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * The access history of every frame is a ring buffer of k timestamps in one flat frame-indexed array. In both cases
+ * the victim is the frame whose oldest remembered timestamp is the smallest, so evictable frames are kept in two
+ * ordered sets keyed by that timestamp: one for frames with less than k accesses, which are always evicted first,
+ * and one for frames with a full history. RecordAccess, SetEvictable, Remove and Evict are all O(log n).
+ *
+ * Accesses hinted as AccessType::Scan do not count as references. A frame that has only been touched by scans sits
+ * at the cold end of the replacer, in a FIFO that is drained before any other frame, and a scan touching a frame
+ * that already has regular references leaves its history alone. A large sequential scan therefore recycles its own
+ * frames instead of flushing the working set of point lookups.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -80,7 +110,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    *
@@ -97,7 +127,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    *
@@ -108,10 +138,12 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. AccessType::Scan accesses are not counted as references
+   * and keep frames that only scans have touched at the cold end of the replacer.
+   * @param page_id the page held by the frame, unused by LRU-K.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
    *
@@ -129,7 +161,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    *
@@ -147,7 +179,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    *
@@ -155,11 +187,32 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
+
+  /**
+   * @brief List the evictable frames in eviction order: frames only touched by scans, then frames with less than k
+   * accesses, then frames with a full history.
+   *
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count frames, the first one being the next victim
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
  private:
-  // Remove maybe_unused if you start using them.
-  std::unordered_map<frame_id_t, LRUKNode> node_store_;
+  /** @return the (eviction key, frame id) pair under which an evictable frame is ordered */
+  auto EvictionKey(frame_id_t frame_id) -> std::pair<size_t, frame_id_t>;
+
+  /** @return the population an evictable frame belongs to, depending on how and how often it was accessed */
+  auto PopulationOf(frame_id_t frame_id) -> std::set<std::pair<size_t, frame_id_t>> &;
+
+  std::vector<LRUKNode> node_store_;  // indexed by frame id
+  std::vector<size_t> history_;       // k timestamps per frame, frame i owns [i * k, (i + 1) * k)
+  /** Evictable frames only touched by scans, ordered by their earliest access. Evicted before anything else. */
+  std::set<std::pair<size_t, frame_id_t>> scan_only_;
+  /** Evictable frames with less than k accesses, ordered by their earliest access. */
+  std::set<std::pair<size_t, frame_id_t>> less_than_k_;
+  /** Evictable frames with k accesses, ordered by their k-th most recent access. */
+  std::set<std::pair<size_t, frame_id_t>> full_history_;
   size_t current_timestamp_{0};
   size_t curr_size_{0};       // overall number of frames
   size_t evictable_size_{0};  // number of evictable frames.
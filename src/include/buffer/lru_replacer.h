@@ -12,17 +12,22 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Evictable frames are kept in an ordered set keyed by their most recent access. A scan access does not refresh a
+ * frame that is already tracked.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -32,21 +37,37 @@ class LRUReplacer : public Replacer {
    */
   explicit LRUReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
+
   /**
    * Destroys the LRUReplacer.
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
  private:
-  // TODO(student): implement me!
+  struct LRUNode {
+    size_t last_access_{0};  // 0 means the frame is not tracked
+    bool is_evictable_{false};
+  };
+
+  std::vector<LRUNode> node_store_;  // indexed by frame id
+  /** Evictable frames ordered by their most recent access. */
+  std::set<std::pair<size_t, frame_id_t>> lru_;
+  size_t current_timestamp_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
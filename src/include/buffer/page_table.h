@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool partition to their frames. It is an open-addressing hash table
+ * with linear probing and a fixed capacity of at least twice the number of frames, so it never has to rehash. A
+ * partition that grows past MaxEntries() switches to a bigger table.
+ *
+ * Insert and Erase must be serialized by the caller (the partition latch). Find may run concurrently with them without
+ * any lock: every slot is a single atomic word, so a concurrent Find never sees a torn entry. It may however miss an
+ * entry that is being moved by a concurrent Erase, or return an entry that has just been erased, so a lock-free Find is
+ * only a hint that the caller has to validate. A Find serialized with the writers is exact.
+ */
+class PageTable {
+ public:
+  /**
+   * @param max_entries the maximum number of entries the table will hold
+   */
+  explicit PageTable(size_t max_entries);
+
+  /**
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /** Map a page, which must not be in the table yet, to a frame. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** Remove a page from the table. @return true if the page was found */
+  auto Erase(page_id_t page_id) -> bool;
+
+  /** @return the number of entries the table was sized for */
+  auto MaxEntries() const -> size_t { return (mask_ + 1) / 2; }
+
+  /** @return the number of pages in the table */
+  auto Size() const -> size_t { return size_; }
+
+  /** Call `f(page_id, frame_id)` for every entry. Must be serialized with the writers. */
+  template <typename F>
+  void ForEach(F &&f) const {
+    for (size_t i = 0; i <= mask_; i++) {
+      uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+      if (slot != EMPTY) {
+        f(PageIdOf(slot), FrameIdOf(slot));
+      }
+    }
+  }
+
+ private:
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageIdOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameIdOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & UINT32_MAX); }
+
+  /** @return the slot a page id hashes to */
+  auto HomeOf(page_id_t page_id) const -> size_t;
+
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Capacity minus one, the capacity is a power of two. */
+  size_t mask_;
+  size_t size_{0};
+};
+
+}  // namespace bustub
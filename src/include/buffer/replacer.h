@@ -12,12 +12,25 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+enum class AccessType { Unknown = 0, Get, Scan };
+
+/** The replacement policies a BufferPoolManager can be built with. */
+enum class ReplacerPolicy { LRUK = 0, LRU, Clock, TwoQueue, ARC };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict when the buffer pool is full.
+ *
+ * A frame becomes tracked when it is accessed for the first time and stops being tracked when it is evicted or
+ * removed. Only tracked frames that are marked evictable may be chosen as victims.
  */
 class Replacer {
  public:
@@ -25,26 +38,67 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Evict the victim frame as defined by the replacement policy and forget its access history.
+   * @param[out] frame_id id of frame that was evicted
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame, starting to track it if it was not tracked yet. Throws if the frame id is invalid.
+   * @param frame_id the id of the accessed frame
+   * @param access_type the kind of access, AccessType::Scan accesses should not promote frames
+   * @param page_id the page held by the frame, used by policies that remember recently evicted pages
+   */
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                            page_id_t page_id = INVALID_PAGE_ID) = 0;
+
+  /**
+   * Mark a tracked frame as evictable or not. Throws if the frame is not tracked.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame may be evicted
+   */
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Stop tracking an evictable frame, e.g. because its page was deleted. Does nothing if the frame is not tracked and
+   * throws if it is not evictable.
+   * @param frame_id the id of the frame to remove
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Evict a frame picked by the caller, e.g. among EvictionCandidates, and record it like Evict records its victims.
+   * Policies that keep no history of evicted pages use the default, which is Remove. Does nothing if the frame is not
+   * tracked and throws if it is not evictable.
+   * @param frame_id the id of the frame to evict
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void EvictFrame(frame_id_t frame_id) { Remove(frame_id); }
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * List the evictable frames in the order Evict would pick them, without changing any state. Policies whose choice
+   * depends on the incoming page may return an approximation of that order.
+   * @param max_count the maximum number of frames to return
+   * @return up to max_count frames, the first one being the next victim
+   */
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Create a replacer implementing the given policy.
+   * @param policy the replacement policy
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   * @param k the lookback constant, only used by the LRU-K policy
+   */
+  static auto Create(ReplacerPolicy policy, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
 };
 
+/** @return the policy named by a string such as "lru_k", "lru", "clock", "2q" or "arc", ignoring case */
+auto ReplacerPolicyFromString(const std::string &name) -> std::optional<ReplacerPolicy>;
+
+/** @return the canonical name of a policy, the inverse of ReplacerPolicyFromString */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy of Johnson and Shasha.
+ *
+ * A frame accessed for the first time enters A1in, a FIFO that holds roughly a quarter of the frames. Further
+ * accesses while it is in A1in do not promote it, so correlated references are absorbed. When a frame is evicted from
+ * A1in its page id is remembered in the ghost list A1out, and a page that is fetched again while still in A1out goes
+ * straight to Am, an LRU list of hot frames. A1in is drained first whenever it is over its target size.
+ *
+ * Scan accesses never promote a frame to Am, and frames only touched by scans are not remembered in A1out.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * @brief a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown,
+                    page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void EvictFrame(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+ private:
+  enum class Queue { None = 0, A1In, Am };
+
+  struct TwoQueueNode {
+    Queue queue_{Queue::None};
+    size_t timestamp_{0};  // first access in A1in, most recent access in Am
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool is_evictable_{false};
+    bool scan_only_{false};
+  };
+
+  /** @return the set holding the frame while it is evictable */
+  auto QueueOf(const TwoQueueNode &node) -> std::set<std::pair<size_t, frame_id_t>> & {
+    return node.queue_ == Queue::A1In ? a1in_ : am_;
+  }
+
+  /** Evict an evictable frame, remembering its page in A1out if it leaves A1in. Requires latch_. */
+  void EvictLocked(frame_id_t frame_id);
+
+  std::vector<TwoQueueNode> node_store_;  // indexed by frame id
+  /** Evictable frames of A1in in FIFO order. */
+  std::set<std::pair<size_t, frame_id_t>> a1in_;
+  /** Evictable frames of Am in LRU order. */
+  std::set<std::pair<size_t, frame_id_t>> am_;
+  GhostList a1out_;
+  size_t a1in_size_{0};  // tracked frames in A1in, evictable or not
+  size_t kin_;           // target size of A1in
+  size_t kout_;          // capacity of A1out
+  size_t current_timestamp_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
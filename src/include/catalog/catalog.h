@@ -56,6 +56,8 @@ struct TableInfo {
   std::unique_ptr<TableHeap> table_;
   /** The table OID */
   const table_oid_t oid_;
+  /** The buffer group of the pages of the table, DEFAULT_BUFFER_GROUP until the table is given a buffer quota */
+  buffer_group_t buffer_group_{DEFAULT_BUFFER_GROUP};
 };
 
 /**
@@ -91,6 +93,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The buffer group of the pages of the index, DEFAULT_BUFFER_GROUP until the index is given a buffer quota */
+  buffer_group_t buffer_group_{DEFAULT_BUFFER_GROUP};
 };
 
 /**
@@ -228,12 +232,19 @@ class Catalog {
     // TODO(chi): support both hash index and btree index
     auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all live tuples in table heap, building it bottom-up from the sorted keys
     auto *table_meta = GetTable(table_name);
+    std::vector<std::pair<KeyType, ValueType>> entries;
     for (auto iter = table_meta->table_->MakeIterator(); !iter.IsEnd(); ++iter) {
       auto [meta, tuple] = iter.GetTuple();
-      index->InsertEntry(tuple.KeyFromTuple(schema, key_schema, key_attrs), tuple.GetRid(), txn);
+      if (meta.is_deleted_) {
+        continue;
+      }
+      KeyType index_key;
+      index_key.SetFromKey(tuple.KeyFromTuple(schema, key_schema, key_attrs));
+      entries.emplace_back(index_key, tuple.GetRid());
     }
+    index->BulkLoad(std::move(entries));
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -250,6 +261,48 @@ class Catalog {
     return tmp;
   }
 
+  /**
+   * Set the share of the buffer pool the pages of a table are entitled to. The first quota places the pages of the
+   * table in a buffer group of their own.
+   * @param table_name The name of the table
+   * @param quota The reserved frames and priority class of the pages of the table
+   * @return false if the table does not exist or the catalog has no buffer pool
+   */
+  auto SetTableBufferQuota(const std::string &table_name, const BufferQuota &quota) -> bool {
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO || table_info->table_ == nullptr || bpm_ == nullptr) {
+      return false;
+    }
+    if (table_info->buffer_group_ == DEFAULT_BUFFER_GROUP) {
+      table_info->buffer_group_ = bpm_->CreateBufferGroup();
+      table_info->table_->SetBufferGroup(table_info->buffer_group_);
+    }
+    bpm_->SetBufferQuota(table_info->buffer_group_, quota);
+    return true;
+  }
+
+  /**
+   * Set the share of the buffer pool the pages of an index are entitled to. The first quota places the pages of the
+   * index in a buffer group of their own.
+   * @param index_name The name of the index
+   * @param table_name The name of the table on which the index is created
+   * @param quota The reserved frames and priority class of the pages of the index
+   * @return false if the index does not exist or the catalog has no buffer pool
+   */
+  auto SetIndexBufferQuota(const std::string &index_name, const std::string &table_name, const BufferQuota &quota)
+      -> bool {
+    auto *index_info = GetIndex(index_name, table_name);
+    if (index_info == NULL_INDEX_INFO || bpm_ == nullptr) {
+      return false;
+    }
+    if (index_info->buffer_group_ == DEFAULT_BUFFER_GROUP) {
+      index_info->buffer_group_ = bpm_->CreateBufferGroup();
+      index_info->index_->SetBufferGroup(index_info->buffer_group_);
+    }
+    bpm_->SetBufferQuota(index_info->buffer_group_, quota);
+    return true;
+  }
+
   /**
    * Get the index `index_name` for table `table_name`.
    * @param index_name The name of the index for which to query
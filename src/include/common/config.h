@@ -16,6 +16,15 @@
 #include <chrono>  // NOLINT
 #include <cstdint>
 
+/**
+ * The size of a database page, chosen when BusTub is built with -DBUSTUB_PAGE_SIZE=<bytes>. Every page layout is sized
+ * from it at compile time. A db file records the page size it was created with and cannot be opened by a build with a
+ * different one.
+ */
+#ifndef BUSTUB_PAGE_SIZE_BYTES
+#define BUSTUB_PAGE_SIZE_BYTES 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -27,15 +36,66 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background flusher of the buffer pool wakes up every BPM_FLUSHER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bpm_flusher_interval;
+
+/**
+ * The background flusher starts cleaning a buffer pool partition when less than BPM_FLUSHER_LOW_WATERMARK of its
+ * frames can be reused without a write, i.e. are free or hold a clean unpinned page, and cleans dirty unpinned pages
+ * until BPM_FLUSHER_HIGH_WATERMARK of the frames can be reused. Both are fractions of the partition size.
+ */
+extern double bpm_flusher_low_watermark;
+extern double bpm_flusher_high_watermark;
+
+/** The background flusher writes at most BPM_FLUSHER_MAX_PAGES pages per partition each time it wakes up. */
+extern size_t bpm_flusher_max_pages;
+
+/** Sequential scans of a table heap keep reads of up to TABLE_SCAN_READ_AHEAD pages in flight, 0 disables it. */
+extern size_t table_scan_read_ahead;
+
+/** How long shrinking the buffer pool waits for pinned frames to be released before giving up. */
+extern std::chrono::milliseconds bpm_resize_timeout;
+
+/** The background flusher rewrites the warm-up file of the buffer pool every BPM_WARMUP_DUMP_INTERVAL. */
+extern std::chrono::milliseconds bpm_warmup_dump_interval;
+
+/**
+ * Capacity in bytes of the compressed page cache that a buffer pool puts between itself and the disk manager, 0
+ * disables it. Read when the buffer pool is created.
+ */
+extern size_t bpm_compressed_cache_size;
+
+/**
+ * Back the frames of the buffer pool with huge pages when possible, hugetlb pages first, then transparent huge pages.
+ * Read when frames are allocated.
+ */
+extern bool bpm_use_huge_pages;
+
+/**
+ * Fraction of the capacity of each page that a bulk-loaded B+ tree fills, leaving the rest for later inserts. Pages
+ * are never filled below their minimum size.
+ */
+extern double bplustree_bulk_load_fill_factor;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = BUSTUB_PAGE_SIZE_BYTES;                      // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int BPM_ACCESS_BUFFER_SIZE = 256;  // lock-free page hits buffered per partition, a power of two
+static constexpr int BPM_FRAME_CHUNK_SIZE = 64;      // frames of the first chunk of a partition, a power of two
+static constexpr int BUSTUB_CACHE_LINE_SIZE = 64;    // size of a cpu cache line in byte
+static constexpr int BPM_FLUSH_BATCH_PAGES = 256;    // pages FlushAllPages copies out before waiting for writes
+static constexpr int BPM_QUOTA_EVICTION_PEEK = 64;   // eviction candidates ranked per miss in a partition with quotas
+static constexpr int BPLUSTREE_OPTIMISTIC_RETRIES = 8;  // optimistic B+ tree lookups restarted before latching
+
+// TablePage stores tuple offsets in 16 bits, direct I/O needs pages of at least 4 KB.
+static_assert(BUSTUB_PAGE_SIZE >= 4096 && BUSTUB_PAGE_SIZE <= 32768, "page size must be between 4 KB and 32 KB");
+static_assert((BUSTUB_PAGE_SIZE & (BUSTUB_PAGE_SIZE - 1)) == 0, "page size must be a power of two");
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -43,6 +103,9 @@ using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
+using buffer_group_t = uint32_t;  // buffer pool group id type
+
+static constexpr buffer_group_t DEFAULT_BUFFER_GROUP = 0;  // group of the pages not placed in any buffer group
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>  // NOLINT
 #include <shared_mutex>
 
@@ -21,18 +23,33 @@ namespace bustub {
 
 /**
  * Reader-Writer latch backed by std::mutex.
+ *
+ * Besides read and write latches it offers upgrade latches. An upgrade latch is shared with readers but excludes
+ * writers and other upgraders, so its holder can later turn it into a write latch knowing that nobody wrote in
+ * between. Writers and upgraders first take intent_mutex_, which orders them among themselves.
+ *
+ * The latch also keeps a version counter that is odd while a write latch is held and grows with every write latch.
+ * Optimistic readers read the version, read the protected data without a latch and validate the version afterwards.
  */
 class ReaderWriterLatch {
  public:
   /**
    * Acquire a write latch.
    */
-  void WLock() { mutex_.lock(); }
+  void WLock() {
+    intent_mutex_.lock();
+    mutex_.lock();
+    BeginWrite();
+  }
 
   /**
    * Release a write latch.
    */
-  void WUnlock() { mutex_.unlock(); }
+  void WUnlock() {
+    version_.fetch_add(1, std::memory_order_release);
+    mutex_.unlock();
+    intent_mutex_.unlock();
+  }
 
   /**
    * Acquire a read latch.
@@ -44,8 +61,81 @@ class ReaderWriterLatch {
    */
   void RUnlock() { mutex_.unlock_shared(); }
 
+  /**
+   * Acquire an upgrade latch. Readers may still come and go, writers and other upgraders wait.
+   */
+  void ULock() {
+    intent_mutex_.lock();
+    mutex_.lock_shared();
+  }
+
+  /**
+   * Release an upgrade latch.
+   */
+  void UUnlock() {
+    mutex_.unlock_shared();
+    intent_mutex_.unlock();
+  }
+
+  /**
+   * Turn a held upgrade latch into a write latch, waiting for the readers to leave. Release it with WUnlock.
+   */
+  void Upgrade() {
+    mutex_.unlock_shared();
+    mutex_.lock();
+    BeginWrite();
+  }
+
+  /**
+   * Try to turn a held read latch into a write latch. Fails without waiting if a writer or an upgrader holds or waits
+   * for the latch, in which case the read latch is still held.
+   * @return true if the write latch is held, release it with WUnlock
+   */
+  auto TryUpgrade() -> bool {
+    if (!intent_mutex_.try_lock()) {
+      return false;
+    }
+    mutex_.unlock_shared();
+    mutex_.lock();
+    BeginWrite();
+    return true;
+  }
+
+  /**
+   * Read the version before an optimistic read.
+   * @return the version, odd if a write latch is held
+   */
+  auto ReadVersion() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Check that no write latch was taken since an optimistic read started.
+   * @param version the version returned by ReadVersion before the read
+   * @return true if the data read since then is consistent
+   */
+  auto ValidateVersion(uint64_t version) const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+  /**
+   * Fail the optimistic reads in progress without taking the latch, for an owner that replaces the protected data by
+   * other means. The version stays even.
+   */
+  void InvalidateVersion() {
+    version_.fetch_add(2, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
  private:
+  /** Make the version odd before the holder of the write latch changes anything. */
+  void BeginWrite() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
   std::shared_mutex mutex_;
+  std::mutex intent_mutex_;
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
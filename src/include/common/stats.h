@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stats.h
+//
+// Identification: src/include/common/stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+
+namespace bustub {
+
+/** Number of buckets of a latency histogram. Bucket 0 counts latencies below 1us, bucket i latencies in
+ * [2^(i-1), 2^i) us, and the last bucket everything above. */
+static constexpr size_t LATENCY_HISTOGRAM_BUCKETS = 24;
+
+/**
+ * A snapshot of a latency histogram with power-of-two microsecond buckets.
+ */
+struct LatencyHistogram {
+  std::array<uint64_t, LATENCY_HISTOGRAM_BUCKETS> buckets_{};
+  /** Sum of all recorded latencies, in microseconds. */
+  uint64_t total_us_{0};
+
+  /** @return the bucket a latency falls into */
+  static auto BucketOf(uint64_t latency_us) -> size_t {
+    size_t bucket = 0;
+    while (latency_us > 0 && bucket + 1 < LATENCY_HISTOGRAM_BUCKETS) {
+      latency_us >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /** @return the exclusive upper bound of a bucket, in microseconds */
+  static auto BucketUpperBound(size_t bucket) -> uint64_t { return uint64_t{1} << bucket; }
+
+  /** @return the number of recorded latencies */
+  auto Count() const -> uint64_t {
+    uint64_t count = 0;
+    for (auto n : buckets_) {
+      count += n;
+    }
+    return count;
+  }
+
+  /** @return the mean latency in microseconds, 0 if nothing was recorded */
+  auto Mean() const -> double {
+    uint64_t count = Count();
+    return count == 0 ? 0 : static_cast<double>(total_us_) / count;
+  }
+
+  /** @return the upper bound, in microseconds, of the bucket holding the p-th percentile (0 < p <= 1) */
+  auto Percentile(double p) const -> uint64_t {
+    uint64_t count = Count();
+    if (count == 0) {
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(p * count + 0.5);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+      seen += buckets_[i];
+      if (seen >= rank && buckets_[i] > 0) {
+        return BucketUpperBound(i);
+      }
+    }
+    return BucketUpperBound(LATENCY_HISTOGRAM_BUCKETS - 1);
+  }
+};
+
+/** Number of shards of ShardedStats, threads beyond this share shards. */
+static constexpr size_t STATS_SHARDS = 64;
+
+/**
+ * ShardedStats is a set of counters and latency histograms that many threads update without locks. Every thread
+ * updates its own cache-line-aligned shard with relaxed atomic adds, so updates from different threads never contend
+ * on a cache line; readers sum all shards. Readings are not an atomic snapshot across counters.
+ *
+ * @tparam NumCounters number of counters, indexed by the caller's enum
+ * @tparam NumHistograms number of latency histograms, indexed by the caller's enum
+ */
+template <size_t NumCounters, size_t NumHistograms>
+class ShardedStats {
+ public:
+  ShardedStats() : shards_(new Shard[STATS_SHARDS]) {}
+
+  /** Add `delta` to a counter. */
+  void Add(size_t counter, uint64_t delta = 1) {
+    Local().counters_[counter].fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /** Record a latency in a histogram. */
+  void RecordLatency(size_t histogram, std::chrono::nanoseconds latency) {
+    auto latency_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    auto &shard = Local();
+    shard.buckets_[histogram][LatencyHistogram::BucketOf(latency_us)].fetch_add(1, std::memory_order_relaxed);
+    shard.total_us_[histogram].fetch_add(latency_us, std::memory_order_relaxed);
+  }
+
+  /** @return the sum of a counter over all shards */
+  auto Get(size_t counter) const -> uint64_t {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+      sum += shards_[i].counters_[counter].load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  /** @return a histogram merged over all shards */
+  auto GetHistogram(size_t histogram) const -> LatencyHistogram {
+    LatencyHistogram result;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+      for (size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++) {
+        result.buckets_[b] += shards_[i].buckets_[histogram][b].load(std::memory_order_relaxed);
+      }
+      result.total_us_ += shards_[i].total_us_[histogram].load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+
+  /** Set every counter and histogram back to zero. */
+  void Reset() {
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+      for (auto &counter : shards_[i].counters_) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+      for (auto &buckets : shards_[i].buckets_) {
+        for (auto &bucket : buckets) {
+          bucket.store(0, std::memory_order_relaxed);
+        }
+      }
+      for (auto &total : shards_[i].total_us_) {
+        total.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, NumCounters> counters_{};
+    std::array<std::array<std::atomic<uint64_t>, LATENCY_HISTOGRAM_BUCKETS>, NumHistograms> buckets_{};
+    std::array<std::atomic<uint64_t>, NumHistograms> total_us_{};
+  };
+
+  /** @return the shard of the calling thread */
+  auto Local() -> Shard & {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % STATS_SHARDS;
+    return shards_[shard];
+  }
+
+  std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * Measures the time between construction and destruction into a histogram of a ShardedStats.
+ */
+template <typename Stats>
+class ScopedLatency {
+ public:
+  ScopedLatency(Stats *stats, size_t histogram)
+      : stats_(stats), histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedLatency() { stats_->RecordLatency(histogram_, std::chrono::steady_clock::now() - start_); }
+
+  ScopedLatency(const ScopedLatency &) = delete;
+  auto operator=(const ScopedLatency &) -> ScopedLatency & = delete;
+
+ private:
+  Stats *stats_;
+  size_t histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace bustub
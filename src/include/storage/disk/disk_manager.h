@@ -14,38 +14,83 @@
 
 #include <atomic>
 #include <fstream>
+#include <sys/uio.h>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "common/stats.h"
 
 namespace bustub {
 
+/**
+ * When the disk manager forces written pages to stable storage with fdatasync.
+ * - PerWrite: after every WritePage. Of the free page map only the pages that handed out a page id are written with it,
+ *   freed page ids are left to the next Sync or SyncBatch.
+ * - PerBatch: when the buffer pool finishes a batch of writes (SyncBatch).
+ * - OnCheckpoint: only when Sync is called, e.g. by FlushAllPages or ShutDown.
+ */
+enum class DiskSyncPolicy { PerWrite = 0, PerBatch, OnCheckpoint };
+
+/** Parses a sync policy name such as "per_write", "per_batch" or "on_checkpoint". */
+auto DiskSyncPolicyFromString(const std::string &name) -> std::optional<DiskSyncPolicy>;
+
+/** @return the canonical name of the sync policy */
+auto DiskSyncPolicyToString(DiskSyncPolicy policy) -> std::string;
+
+/**
+ * A reading of the statistics of a DiskManager. Latencies are measured around each page read/write and each
+ * fdatasync of the db file.
+ */
+struct DiskManagerStats {
+  uint64_t reads_{0};
+  uint64_t writes_{0};
+  uint64_t syncs_{0};
+  uint64_t log_flushes_{0};
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  LatencyHistogram sync_latency_;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Deallocated pages are tracked in a free page map, a bitmap with one bit per page that is stored in dedicated pages of
+ * the db file. The file is divided into groups of PAGES_PER_FREE_MAP pages, each preceded by the map page covering it,
+ * so the map grows with the file and page ids do not have to skip the map pages.
+ *
+ * The first page of the db file is a header recording the format version and the page size the file was created
+ * with. Opening a file created with another page size, or a file that is not a db file, throws an Exception.
  */
 class DiskManager {
  public:
+  /** Number of pages covered by one free page map page. */
+  static constexpr size_t PAGES_PER_FREE_MAP = BUSTUB_PAGE_SIZE * 8;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param sync_policy when written pages are forced to stable storage
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskSyncPolicy sync_policy = DiskSyncPolicy::OnCheckpoint);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Pages are written with pwrite, so concurrent writes to different pages do not
+   * serialize on a latch.
    * @param page_id id of the page
    * @param page_data raw page data
    */
@@ -58,6 +103,102 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Start writing a page. The data must stay valid and unchanged until the returned future is ready. The default
+   * implementation writes synchronously and returns a ready future.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return a future that becomes ready once the write completes
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Start writing a run of contiguous pages with a single vectored write. The data must stay valid and unchanged until
+   * the returned future is ready. The default implementation writes synchronously with pwritev.
+   * @param first_page_id id of the first page of the run
+   * @param pages raw page data, pages[i] is written to page first_page_id + i
+   * @return a future that becomes ready once all pages are written
+   */
+  virtual auto WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages) -> std::future<void>;
+
+  /**
+   * Start reading a page. The buffer must stay valid until the returned future is ready. The default implementation
+   * reads synchronously and returns a ready future.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return a future that becomes ready once the read completes
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Start reading a run of contiguous pages with a single vectored read. The buffers must stay valid until the
+   * returned future is ready. The default implementation reads synchronously with preadv.
+   * @param first_page_id id of the first page of the run
+   * @param[out] pages output buffers, page first_page_id + i is read into pages[i]
+   * @return a future that becomes ready once all pages are read
+   */
+  virtual auto ReadPagesAsync(page_id_t first_page_id, const std::vector<char *> &pages) -> std::future<void>;
+
+  /**
+   * Mark the end of a batch of page writes. Syncs the database file if the policy is PerBatch.
+   */
+  virtual void SyncBatch();
+
+  /**
+   * Write back the dirty free page map pages and force all written pages to stable storage regardless of the sync
+   * policy.
+   */
+  virtual void Sync();
+
+  /**
+   * Mark a page as free so that its id can be handed out again by AllocateFreePage. The change is persisted in the
+   * free page map on the next Sync.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Take the lowest free page id below `limit` that is congruent to `offset` modulo `stride`, so that the file stays
+   * dense. The stride lets buffer pool partitions reuse only the page ids they own. The free pages of each stripe are
+   * counted for the last stride, so a stripe without free pages returns at once.
+   * @return the page id, or INVALID_PAGE_ID if there is no such free page
+   */
+  auto AllocateFreePage(page_id_t limit, size_t stride = 1, size_t offset = 0) -> page_id_t;
+
+  /**
+   * Mark a page that was allocated without AllocateFreePage as in use, in case the free page map still lists it.
+   * @param page_id id of the page
+   */
+  void ClaimPage(page_id_t page_id);
+
+  /** @return true if the page is in the free page map */
+  auto IsPageFree(page_id_t page_id) -> bool;
+
+  /** @return the number of pages in the free page map */
+  auto GetNumFreePages() -> size_t;
+
+  /**
+   * Read the page size recorded in the header of a db file, e.g. to report which build can open it.
+   * @return the page size, or std::nullopt if the file does not exist or is not a db file
+   */
+  static auto ReadFilePageSize(const std::string &db_file) -> std::optional<uint32_t>;
+
+  /** @return the number of pages the db file has room for, not counting the header and free page map pages */
+  auto GetNumPages() const -> size_t;
+
+  /**
+   * Offline compaction: truncate the db file after the last page that is not free. Must not run while a buffer pool
+   * uses this disk manager.
+   * @return the number of pages dropped from the end of the file
+   */
+  auto TruncateFreeTail() -> size_t;
+
+  /** @return the current sync policy */
+  auto GetSyncPolicy() const -> DiskSyncPolicy { return sync_policy_; }
+
+  /** Change when written pages are forced to stable storage. */
+  void SetSyncPolicy(DiskSyncPolicy sync_policy) { sync_policy_ = sync_policy; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +224,15 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of fdatasync calls on the database file */
+  auto GetNumSyncs() const -> int;
+
+  /** @return the counters and latency histograms of this disk manager */
+  auto GetStats() const -> DiskManagerStats;
+
+  /** Reset every counter and latency histogram to zero. */
+  void ResetStats();
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,18 +244,74 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+  /** Grow the cached db file size after a write that ends at `end`. */
+  void GrowFileSize(int64_t end);
+  /** @return the offset of a page in the db file */
+  static auto PageOffset(page_id_t page_id) -> int64_t;
+  /** @return the offset of the free page map page of a group in the db file */
+  static auto FreeMapOffset(size_t group) -> int64_t;
+  /** Write a run of buffers at the given offset with pwritev, retrying partial writes. */
+  void WriteVectored(std::vector<iovec> *iovs, int64_t offset);
+  /** Read a run of buffers at the given offset with preadv, retrying partial reads and zero-filling past the end. */
+  void ReadVectored(std::vector<iovec> *iovs, int64_t offset);
+
+  static constexpr size_t WORDS_PER_FREE_MAP = BUSTUB_PAGE_SIZE / sizeof(uint64_t);
+  /** Write the header of a new db file, or check the header of an existing one. */
+  void ReadOrWriteFileHeader();
+  /** Requires free_map_latch_. `allocated` is true if the page was taken out of the map. */
+  void MarkFreeMapDirty(page_id_t page_id, bool allocated = false);
+  /** Requires free_map_latch_. Count a page that was added to (`freed`) or taken out of the free page map. */
+  void CountFreePage(page_id_t page_id, bool freed);
+  void ReadFreePageMap();
+  /**
+   * Write the dirty free page map pages back to the db file.
+   * @param allocations_only only write the pages of groups that handed out a page id since they were last written
+   */
+  void WriteFreePageMap(bool allocations_only = false);
+  /**
+   * fdatasync the db file, used by the PerWrite policy. The free page map pages that handed out a page id are written
+   * first: a reused page must not be free in the map on disk once its new data is durable. Pages freed since the last
+   * Sync are not written, losing them after a crash only leaks their space.
+   */
+  void SyncData();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, accessed with positional pread/pwrite so no latch is needed
+  int db_fd_{-1};
   std::string file_name_;
-  int num_flushes_{0};
-  int num_writes_{0};
+  // cached size of the db file, only grows as pages are written past the end
+  std::atomic<int64_t> db_file_size_{0};
+  std::atomic<DiskSyncPolicy> sync_policy_{DiskSyncPolicy::OnCheckpoint};
+
+  enum class StatCounter : size_t { Reads = 0, Writes, Syncs, LogFlushes, Count };
+  enum class StatHistogram : size_t { ReadLatency = 0, WriteLatency, SyncLatency, Count };
+  using Stats = ShardedStats<static_cast<size_t>(StatCounter::Count), static_cast<size_t>(StatHistogram::Count)>;
+  /** Per-thread counters, updated without locks. */
+  Stats stats_;
+  void CountStat(StatCounter counter, uint64_t delta = 1) { stats_.Add(static_cast<size_t>(counter), delta); }
+  /** @return a timer recording into the given histogram when it goes out of scope */
+  auto TimeStat(StatHistogram histogram) -> ScopedLatency<Stats> {
+    return ScopedLatency<Stats>(&stats_, static_cast<size_t>(histogram));
+  }
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+
+  /** Protects the free page map. */
+  std::mutex free_map_latch_;
+  /** Bit i is set if page i is free. */
+  std::vector<uint64_t> free_map_;
+  /** Per-group flag, true if the map page of the group has to be written back. */
+  std::vector<bool> free_map_dirty_;
+  /** Per-group flag, true if a page id of the group was handed out since the map page was last written. */
+  std::vector<bool> free_map_allocated_;
+  /** True if any flag of free_map_allocated_ is set, checked without the latch by SyncData. */
+  std::atomic<bool> has_free_map_allocations_{false};
+  size_t num_free_pages_{0};
+  /** Stride of the last AllocateFreePage call, 0 before the first one. */
+  size_t stripe_stride_{0};
+  /** Number of free pages per stripe of stripe_stride_, indexed by page id modulo the stride. */
+  std::vector<size_t> stripe_free_pages_;
 };
 
 }  // namespace bustub
@@ -71,6 +71,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data) override {
+    CountStat(StatCounter::Writes);
+    auto timer = TimeStat(StatHistogram::WriteLatency);
     if (latency_ > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
@@ -95,6 +97,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data) override {
+    CountStat(StatCounter::Reads);
+    auto timer = TimeStat(StatHistogram::ReadLatency);
     if (latency_ > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
     }
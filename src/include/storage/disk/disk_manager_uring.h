@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.h
+//
+// Identification: src/include/storage/disk/disk_manager_uring.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * DiskManagerUring submits page reads and writes through io_uring so that many page I/Os can be in flight at once.
+ * A reaper thread completes the futures returned by ReadPageAsync/WritePageAsync; the synchronous ReadPage/WritePage
+ * submit a request and wait for it.
+ *
+ * With direct I/O the db file is accessed with O_DIRECT. Buffers that are not page-aligned are copied through an
+ * aligned bounce buffer. If io_uring cannot be set up at runtime (old kernel, seccomp, non-Linux build) the disk
+ * manager falls back to the pread/pwrite implementation of DiskManager, and direct I/O stays off.
+ */
+class DiskManagerUring : public DiskManager {
+ public:
+  /**
+   * Creates a new io_uring disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param sync_policy when written pages are forced to stable storage
+   * @param direct_io open the db file with O_DIRECT, bypassing the OS page cache
+   * @param queue_depth the maximum number of page I/Os in flight
+   */
+  explicit DiskManagerUring(const std::string &db_file, DiskSyncPolicy sync_policy = DiskSyncPolicy::OnCheckpoint,
+                            bool direct_io = false, uint32_t queue_depth = 128);
+
+  ~DiskManagerUring() override;
+
+  /**
+   * Waits for all in-flight I/Os, tears down the ring and closes the files.
+   */
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  /**
+   * Submits every page of the run as its own request so that they are all in flight at once; the returned future
+   * waits for all of them.
+   */
+  auto WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages) -> std::future<void> override;
+
+  /** Submits every page of the run as its own request, like WritePagesAsync. */
+  auto ReadPagesAsync(page_id_t first_page_id, const std::vector<char *> &pages) -> std::future<void> override;
+
+  /** @return true if I/O goes through io_uring, false if it fell back to pread/pwrite */
+  auto IsUringEnabled() const -> bool { return ring_fd_ >= 0; }
+
+  /** @return true if the db file is accessed with O_DIRECT */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+ private:
+  /** A page read or write in flight. Owned by the ring from submission until completion. */
+  struct Request {
+    bool is_write_;
+    page_id_t page_id_;
+    /** The caller's buffer. */
+    char *data_;
+    /** Page-aligned copy of the caller's buffer, only used for unaligned buffers under direct I/O. */
+    char *bounce_{nullptr};
+    /** Bytes transferred so far; short transfers are resubmitted. */
+    size_t done_{0};
+    /** The remaining part of the transfer, referenced by the submitted readv/writev. */
+    iovec iov_;
+    /** When the request was submitted, for the latency histograms. */
+    std::chrono::steady_clock::time_point start_;
+    std::promise<void> promise_;
+  };
+
+  auto SetUpRing(uint32_t entries) -> bool;
+  void TearDownRing();
+  auto Submit(bool is_write, page_id_t page_id, char *page_data) -> std::future<void>;
+  /**
+   * Queue the remaining part of a request on the submission ring. Requires submit_latch_.
+   * @return false if io_uring_enter failed and the request was taken back off the ring, see FinishWithoutRing
+   */
+  auto PushRequest(Request *request) -> bool;
+  /** Transfer the remaining part of a request the ring did not take with pread/pwrite, then complete it. */
+  void FinishWithoutRing(Request *request);
+  /** Resolve a request, copying out of the bounce buffer and releasing its slot. */
+  void CompleteRequest(Request *request);
+  /** The loop of the reaper thread. */
+  void RunReaper();
+
+  bool direct_io_{false};
+  int ring_fd_{-1};
+  uint32_t sq_entries_{0};
+
+  // mmap-ed rings shared with the kernel
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Protects the submission ring and in_flight_. */
+  std::mutex submit_latch_;
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+  std::atomic<bool> stop_{false};
+  std::thread reaper_thread_;
+};
+
+}  // namespace bustub
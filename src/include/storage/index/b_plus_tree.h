@@ -11,12 +11,14 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <iostream>
 #include <optional>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -58,6 +60,18 @@ class Context {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * How Insert and Remove latch the pages of a B+ tree. Pages always carry high keys and right links, so readers move
+ * right whenever a key is beyond the high key of a page, whatever the protocol.
+ */
+enum class BPlusTreeProtocol {
+  // Write latches from the header page down, released at pages that cannot split or merge. Underfull pages merge.
+  LatchCrabbing,
+  // Lehman-Yao B-link tree. Writers latch one page per level: a split page is released once its new right sibling is
+  // linked, before its parent is latched. Pages are never merged, emptied pages stay in the tree.
+  BLink,
+};
+
 // Main class providing the API for the Interactive B+ Tree.
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -67,7 +81,8 @@ class BPlusTree {
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
                      const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int internal_max_size = INTERNAL_PAGE_SIZE,
+                     BPlusTreeProtocol protocol = BPlusTreeProtocol::LatchCrabbing);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -75,15 +90,30 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
+  // Insert key-value pairs sorted by key, descending once per leaf instead of once per key. Duplicate keys are skipped.
+  // Returns the number of pairs inserted.
+  auto InsertBatch(const std::vector<std::pair<KeyType, ValueType>> &entries, Transaction *txn = nullptr) -> size_t;
+
+  // Build an empty B+ tree bottom-up from unsorted key-value pairs, filling each page to the fill factor. Of duplicate
+  // keys only the first is kept. Returns false if the tree is not empty.
+  auto BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries,
+                double fill_factor = bplustree_bulk_load_fill_factor) -> bool;
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *txn);
 
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
+  // Let GetValue descend without latches, validating page versions, and fall back to read latches on conflicts.
+  void SetOptimisticReads(bool optimistic_reads) { optimistic_reads_ = optimistic_reads; }
+
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // Place every page of this B+ tree, and the pages it allocates from now on, in a buffer group of the buffer pool.
+  void SetBufferGroup(buffer_group_t group);
+
   // Index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
 
@@ -134,7 +164,58 @@ class BPlusTree {
 
   void InsertIntoInternalNode(WritePageGuard &parent_guard, KeyType key, page_id_t page_id, Context &ctx);
 
-  void UpdateInternalNode(WritePageGuard child_guard, Context &ctx);
+  // Insert with the B-link protocol
+  auto InsertBLink(const KeyType &key, const ValueType &value) -> bool;
+
+  // Remove with the B-link protocol
+  void RemoveBLink(const KeyType &key);
+
+  // Descend to the leaf for the key, latching one page at a time and moving right where needed. Returns the leaf page
+  // id, INVALID_PAGE_ID if the tree is empty. If path is not null it receives the internal pages passed, root first.
+  auto DescendBLink(const KeyType &key, std::vector<page_id_t> *path) -> page_id_t;
+
+  // Insert the separator of a page of the given height (0 for leaves) and its new right sibling into the parent page,
+  // splitting further up as needed
+  void InsertIntoParentBLink(page_id_t page_id, int height, KeyType separator, page_id_t new_page_id,
+                             std::vector<page_id_t> path);
+
+  // Returns the right link of the page if the key is not below its high key, INVALID_PAGE_ID otherwise
+  auto RightPageFor(const BPlusTreePage *page, const KeyType &key) const -> page_id_t;
+
+  // Follow right links until the page covers the key
+  void MoveRight(ReadPageGuard *guard, const KeyType &key);
+  void MoveRight(WritePageGuard *guard, const KeyType &key);
+
+  // Look up a key without latches. Returns false if a concurrent writer was detected and the lookup must restart,
+  // otherwise sets found and, if found, value.
+  auto TryGetValueOptimistic(const KeyType &key, ValueType *value, bool *found) -> bool;
+
+  // Descend with read latches and return the write-latched leaf for the key, std::nullopt if the tree is empty.
+  // Sets the root page id of the context.
+  auto FetchLeafOptimistic(const KeyType &key, Context &ctx) -> std::optional<WritePageGuard>;
+
+  // Returns true if inserting into the page cannot split it, so its ancestors stay unchanged
+  auto IsInsertSafe(const BPlusTreePage *page) const -> bool;
+
+  // Returns true if removing from the page cannot merge it or change the root, so its ancestors stay unchanged
+  auto IsRemoveSafe(const BPlusTreePage *page, bool is_root) const -> bool;
+
+  // Release the header page and the write latches of all ancestors held in the context
+  void ReleaseAncestors(Context &ctx);
+
+  // Split count entries over the pages of one bulk-loaded level, filling pages to the fill factor but never below
+  // min_entries. Returns the number of entries of each page.
+  auto BulkLoadPageSizes(size_t count, int max_entries, int min_entries, double fill_factor) const -> std::vector<int>;
+
+  // Allocate a page for this B+ tree in its buffer group
+  auto NewTreePage(page_id_t *page_id) -> BasicPageGuard;
+
+  // Delete a page that is no longer linked into the tree. Readers may still pin it, then it is freed after their
+  // last unpin
+  void DeleteTreePage(page_id_t page_id);
+
+  // Place the pages of a subtree in a buffer group
+  void SetSubtreeGroup(page_id_t page_id, buffer_group_t group);
 
   // member variable
   std::string index_name_;
@@ -144,6 +225,9 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   page_id_t header_page_id_;
+  std::atomic<buffer_group_t> buffer_group_{DEFAULT_BUFFER_GROUP};
+  std::atomic<bool> optimistic_reads_{false};
+  BPlusTreeProtocol protocol_;
 };
 
 /**
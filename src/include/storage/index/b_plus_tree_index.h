@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -31,10 +32,17 @@ class BPlusTreeIndex : public Index {
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void SetBufferGroup(buffer_group_t group) override;
+
+  // Fill the empty index with the keys and RIDs of existing tuples, built bottom-up. Returns false if it is not empty.
+  auto BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
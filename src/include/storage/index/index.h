@@ -160,6 +160,17 @@ class Index {
    */
   virtual auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool = 0;
 
+  /**
+   * Insert a batch of entries into the index. Indexes without a batched insert insert the entries one by one.
+   * @param entries The index keys and their RIDs, in any order
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
@@ -176,6 +187,13 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Place the pages of the index in a buffer group of the buffer pool. Indexes that do not keep their pages in the
+   * buffer pool ignore it.
+   * @param group The buffer group
+   */
+  virtual void SetBufferGroup(buffer_group_t group) {}
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
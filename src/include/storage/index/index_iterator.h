@@ -30,7 +30,10 @@ class IndexIterator {
     index_ = index;
     guard_ = std::move(guard);
     bpm_ = bpm;
-    begin_index_ = index;
+    if (index_ == 0 && guard_.template As<LeafPage>()->GetSize() == 0) {
+      NextLeaf();
+    }
+    begin_index_ = index_;
   }
   ~IndexIterator();  // NOLINT
 
@@ -51,6 +54,9 @@ class IndexIterator {
   void Reset() { index_ = begin_index_; }
 
  private:
+  // Move to the first entry of the next non-empty leaf, or to the end. B-link trees keep emptied leaves.
+  void NextLeaf();
+
   // add your own private member variables here
   ReadPageGuard guard_;
   BufferPoolManager *bpm_;
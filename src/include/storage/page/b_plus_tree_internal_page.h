@@ -18,8 +18,8 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 16
+#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(KeyType)) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -32,6 +32,10 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The header is followed by the page id of the next internal page on the same
+ * level and the high key, the separator between the two pages. The last page
+ * of a level has no next page and no high key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -72,6 +76,19 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   auto ValueAt(int index) const -> ValueType;
 
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+
+  /**
+   * 判断key是否在这个page的范围右边，需要沿next page id向右查找
+   * @param key
+   * @param comparator
+   * @return true if the page has a next page and key is not smaller than the high key
+   */
+  auto IsBeyondHighKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
   /**
    * @brief For test only, return a string representing all keys in
    * this internal page, formatted as "(key1,key2,key3,...)"
@@ -116,6 +133,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Add(KeyType key, page_id_t page_id, KeyComparator comparator);
 
+  /**
+   * 把满的page的后一半和新的元素分到new page中，new page接管page的high key，
+   * page的high key变为new page的第一个key。next page id由调用者设置
+   */
   static void RedistributeWithInsert(BPlusTreeInternalPage *page, BPlusTreeInternalPage *new_page, KeyType key,
                                      page_id_t page_id, KeyComparator comparator);
 
@@ -126,11 +147,15 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Remove(KeyType key, KeyComparator comparator);
 
+  /** 将sibling page的所有元素都移动到page，page接管sibling page的next page id和high key */
   static void InternalMerge(BPlusTreeInternalPage *page, BPlusTreeInternalPage *sibling_page);
 
+  /** 在page和右边的sibling page之间移动一个元素，page的high key变为sibling page新的第一个key */
   static void MoveOneKey(BPlusTreeInternalPage *page, BPlusTreeInternalPage *sibling_page);
 
  private:
+  page_id_t next_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -20,7 +20,7 @@ namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 #define LEAF_PAGE_HEADER_SIZE 16
-#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -32,13 +32,17 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 16 bytes followed by a key):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * |  NextPageId (4)
+ * |  NextPageId (4) | HighKey
  *  -----------------------------------------------
+ *
+ * The high key is the separator between this page and the next one: every key
+ * of the page is smaller, every key of the next page is not. The last leaf has
+ * no next page and no high key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -57,6 +61,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+
+  /**
+   * 判断key是否在这个page的范围右边，需要沿next page id向右查找
+   * @param key
+   * @param comparator
+   * @return true if the page has a next page and key is not smaller than the high key
+   */
+  auto IsBeyondHighKey(const KeyType &key, const KeyComparator &comparator) const -> bool;
   auto KeyAt(int index) const -> KeyType;
   auto PairAt(int index) const -> const MappingType &;
 
@@ -68,6 +82,13 @@ class BPlusTreeLeafPage : public BPlusTreePage {
    */
   void Add(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
 
+  /**
+   * 在叶节点末尾追加元素，调用者保证key比已有的key都大，用于bulk load
+   * @param key
+   * @param value
+   */
+  void Append(const KeyType &key, const ValueType &value);
+
   /**
    * 查找叶节点是否有某一key，查找到放到value中，并返回true
    * 查找不到则返回false
@@ -79,7 +100,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   auto LeafFind(const KeyType &key, const KeyComparator &comparator, ValueType *value) const -> bool;
 
   /**
-   * 将page的后一半数据分到new page中
+   * 将page的后一半数据分到new page中，new page接管page的high key，
+   * page的high key变为new page的第一个key。next page id由调用者设置
    * @param page
    * @param new_page
    */
@@ -93,14 +115,14 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void Remove(const KeyType &key, const KeyComparator &comparator);
 
   /**
-   * 从sibling page把第一个元素分给page
+   * 从sibling page把第一个元素分给page，page的high key变为sibling page新的第一个key
    * @param page
    * @param sibling_page
    */
   static void MoveOneKey(BPlusTreeLeafPage *page, BPlusTreeLeafPage *sibling_page);
 
   /**
-   * 将sibling page的所有元素都移动到page
+   * 将sibling page的所有元素都移动到page，page接管sibling page的next page id和high key
    * @param page
    * @param sibling_page
    */
@@ -133,6 +155,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
  private:
   page_id_t next_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -24,29 +25,27 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The Page objects of the buffer pool form an array of book-keeping information separate from the page data. Each
+ * object is aligned to a cache line, so that pinning and latching one page does not bounce the cache line of another.
  */
-class Page {
+class alignas(BUSTUB_CACHE_LINE_SIZE) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() {
-    data_ = new char[BUSTUB_PAGE_SIZE];
-    ResetMemory();
-  }
-
-  /** Default destructor. */
-  ~Page() { delete[] data_; }
+  /** Constructor. The data of the page is attached by the buffer pool manager, it lives in a FrameArena. */
+  Page() = default;
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
+  inline auto GetData() const -> const char * { return data_; }
 
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int { return pin_count_.load(std::memory_order_acquire) & PIN_COUNT_MASK; }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
@@ -63,6 +62,24 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Acquire the page upgrade latch, a read latch that can later become a write latch. */
+  inline void ULatch() { rwlatch_.ULock(); }
+
+  /** Release the page upgrade latch. */
+  inline void UUnlatch() { rwlatch_.UUnlock(); }
+
+  /** Turn the held upgrade latch into the page write latch. */
+  inline void UpgradeLatch() { rwlatch_.Upgrade(); }
+
+  /** Try to turn a held read latch into the page write latch. @return false if the read latch is still held */
+  inline auto TryUpgradeRLatch() -> bool { return rwlatch_.TryUpgrade(); }
+
+  /** @return the version of the page latch, odd while the page is write latched. See ReaderWriterLatch. */
+  inline auto GetVersion() const -> uint64_t { return rwlatch_.ReadVersion(); }
+
+  /** @return true if the page was not write latched since GetVersion returned version */
+  inline auto ValidateVersion(uint64_t version) const -> bool { return rwlatch_.ValidateVersion(version); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -77,20 +94,32 @@ class Page {
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
 
+  /** The low bits of pin_count_ hold the number of pins. */
+  static constexpr int PIN_COUNT_MASK = (1 << 29) - 1;
+  /** Set in pin_count_ while the replacer considers the frame non-evictable. */
+  static constexpr int PIN_NOT_EVICTABLE = 1 << 29;
+  /** The whole pin_count_ while the buffer pool manager reassigns the frame; pins cannot be taken. */
+  static constexpr int PIN_CLAIMED = 1 << 30;
+
  private:
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
-  // we store it as a ptr.
-  char *data_;
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page, a frame of a FrameArena. */
+  char *data_{nullptr};
+  /** The ID of this page. Only changes while the frame is claimed. */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /**
+   * The pin count of this page, together with the PIN_NOT_EVICTABLE flag, or PIN_CLAIMED. Pins are taken and released
+   * with compare-and-swap, so that the buffer pool manager can pin and unpin a resident page without its latch.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** The frame of the buffer pool partition this page object belongs to. */
+  frame_id_t frame_id_ = 0;
+  /** The buffer group of the page held by the frame. Only changes under the partition latch. */
+  buffer_group_t buffer_group_ = DEFAULT_BUFFER_GROUP;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <optional>
+
 #include "storage/page/page.h"
 
 namespace bustub {
 
 class BufferPoolManager;
+class WritePageGuard;
 
 class BasicPageGuard {
  public:
@@ -78,9 +81,19 @@ class BasicPageGuard {
     return reinterpret_cast<T *>(GetDataMut());
   }
 
+  /**
+   * A basic guard pins the page without latching it. Data read through it is only consistent if ValidateVersion
+   * still accepts the version read before.
+   * @return the version of the page, odd while a writer holds the page
+   */
+  auto GetVersion() const -> uint64_t { return page_->GetVersion(); }
+
+  auto ValidateVersion(uint64_t version) const -> bool { return page_->ValidateVersion(version); }
+
  private:
   friend class ReadPageGuard;
   friend class WritePageGuard;
+  friend class UpgradablePageGuard;
 
   BufferPoolManager *bpm_{nullptr};
   Page *page_{nullptr};
@@ -142,6 +155,17 @@ class ReadPageGuard {
     return guard_.As<T>();
   }
 
+  /**
+   * @brief Try to turn the read latch into a write latch, without waiting for other writers
+   *
+   * Upgrading fails if another thread holds or waits for a write or upgrade latch on the page, because two readers
+   * that both wait to upgrade would wait for each other forever. On success this guard is empty afterwards, and the
+   * page is unchanged since it was read. On failure this guard still holds the read latch.
+   *
+   * @return the write guard of the page, or std::nullopt if the latch could not be upgraded
+   */
+  auto TryUpgrade() -> std::optional<WritePageGuard>;
+
  private:
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
@@ -210,8 +234,54 @@ class WritePageGuard {
   }
 
  private:
+  friend class ReadPageGuard;
+  friend class UpgradablePageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * UpgradablePageGuard holds the upgrade latch of a page, for callers that usually only read the page but sometimes
+ * modify it. Readers can share the page with it, while writers and other upgradable guards wait. Upgrade waits for the
+ * readers to leave and turns the guard into a WritePageGuard; nobody can have written the page in between.
+ */
+class UpgradablePageGuard {
+ public:
+  UpgradablePageGuard() = default;
+  UpgradablePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+  UpgradablePageGuard(const UpgradablePageGuard &) = delete;
+  auto operator=(const UpgradablePageGuard &) -> UpgradablePageGuard & = delete;
+
+  UpgradablePageGuard(UpgradablePageGuard &&that) noexcept;
+
+  auto operator=(UpgradablePageGuard &&that) noexcept -> UpgradablePageGuard &;
+
+  /** @brief Release the upgrade latch, then the pin of the page. */
+  void Drop();
+
+  ~UpgradablePageGuard();
+
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  /**
+   * @brief Wait for the readers of the page to leave and take its write latch
+   *
+   * This guard is empty afterwards.
+   *
+   * @return the write guard of the page
+   */
+  auto Upgrade() -> WritePageGuard;
+
+ private:
+  BasicPageGuard guard_;
+};
+
 }  // namespace bustub
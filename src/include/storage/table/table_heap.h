@@ -63,9 +63,10 @@ class TableHeap {
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
+   * @param access_type the access hint passed to the buffer pool, AccessType::Scan for sequential scans
    * @return the meta and tuple
    */
-  auto GetTuple(RID rid) -> std::pair<TupleMeta, Tuple>;
+  auto GetTuple(RID rid, AccessType access_type = AccessType::Unknown) -> std::pair<TupleMeta, Tuple>;
 
   /**
    * Read a tuple meta from the table. Note: if you want to get tuple and meta together, use `GetTuple` insead
@@ -84,6 +85,12 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /**
+   * Place every page of this table, and the pages it allocates from now on, in a buffer group of the buffer pool.
+   * @param group the buffer group
+   */
+  void SetBufferGroup(buffer_group_t group);
+
   /**
    * Update a tuple in place. SHOULD NOT BE USED UNLESS YOU WANT TO OPTIMIZE FOR PROJECT 4.
    * @param meta new tuple meta
@@ -98,6 +105,7 @@ class TableHeap {
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  buffer_group_t buffer_group_{DEFAULT_BUFFER_GROUP}; /* protected by latch_ */
 };
 
 }  // namespace bustub
@@ -48,6 +48,15 @@ class TableIterator {
   auto operator++() -> TableIterator &;
 
  private:
+  /**
+   * Issue prefetches along the next page chain so that up to `table_scan_read_ahead` pages after the current one are
+   * read in the background. The chain is only followed through pages that are already cached, so this never waits
+   * for disk.
+   * @param page_id the page the iterator is on
+   * @param next_page_id the next page id stored in that page
+   */
+  void ReadAhead(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   RID rid_;
 
@@ -55,6 +64,10 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  /** The last page whose read has been scheduled, and how many pages past the current one it is. */
+  page_id_t read_ahead_page_id_{INVALID_PAGE_ID};
+  size_t read_ahead_distance_{0};
 };
 
 }  // namespace bustub
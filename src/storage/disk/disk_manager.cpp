@@ -10,27 +10,74 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/string_util.h"
+#include "fmt/format.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+/** The start of the header page of a db file. */
+struct FileHeader {
+  char magic_[8] = {'B', 'U', 'S', 'T', 'U', 'B', 'D', 'B'};
+  uint32_t version_ = 1;
+  uint32_t page_size_ = BUSTUB_PAGE_SIZE;
+};
+}  // namespace
+
+auto DiskSyncPolicyFromString(const std::string &name) -> std::optional<DiskSyncPolicy> {
+  auto lower = StringUtil::Lower(name);
+  std::replace(lower.begin(), lower.end(), '-', '_');
+  if (lower == "per_write") {
+    return DiskSyncPolicy::PerWrite;
+  }
+  if (lower == "per_batch") {
+    return DiskSyncPolicy::PerBatch;
+  }
+  if (lower == "on_checkpoint") {
+    return DiskSyncPolicy::OnCheckpoint;
+  }
+  return std::nullopt;
+}
+
+auto DiskSyncPolicyToString(DiskSyncPolicy policy) -> std::string {
+  switch (policy) {
+    case DiskSyncPolicy::PerWrite:
+      return "per_write";
+    case DiskSyncPolicy::PerBatch:
+      return "per_batch";
+    case DiskSyncPolicy::OnCheckpoint:
+      return "on_checkpoint";
+  }
+  UNREACHABLE("unknown disk sync policy");
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskSyncPolicy sync_policy)
+    : file_name_(db_file), sync_policy_(sync_policy) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -49,27 +96,37 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  // 不存在则创建
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception("can't stat db file");
   }
+  db_file_size_ = stat_buf.st_size;
+  ReadOrWriteFileHeader();
+  ReadFreePageMap();
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
@@ -78,50 +135,237 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  auto offset = static_cast<off_t>(PageOffset(page_id));
+  CountStat(StatCounter::Writes);
+  {
+    auto timer = TimeStat(StatHistogram::WriteLatency);
+    size_t written = 0;
+    while (written < BUSTUB_PAGE_SIZE) {
+      ssize_t rc = pwrite(db_fd_, page_data + written, BUSTUB_PAGE_SIZE - written, offset + written);
+      if (rc < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // check for I/O error
+        LOG_DEBUG("I/O error while writing");
+        return;
+      }
+      written += rc;
+    }
+  }
+  GrowFileSize(offset + BUSTUB_PAGE_SIZE);
+  if (sync_policy_ == DiskSyncPolicy::PerWrite) {
+    SyncData();
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  auto offset = static_cast<off_t>(PageOffset(page_id));
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_.load()) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
+    return;
+  }
+  CountStat(StatCounter::Reads);
+  auto timer = TimeStat(StatHistogram::ReadLatency);
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, page_data + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading BUSTUB_PAGE_SIZE
+  if (read_count < BUSTUB_PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  }
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  std::promise<void> promise;
+  WritePage(page_id, page_data);
+  promise.set_value();
+  return promise.get_future();
+}
+
+auto DiskManager::WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages)
+    -> std::future<void> {
+  std::promise<void> promise;
+  if (db_fd_ < 0) {
+    // DiskManagerMemory等子类没有文件，逐个page写
+    for (size_t i = 0; i < pages.size(); i++) {
+      WritePage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+    promise.set_value();
+    return promise.get_future();
+  }
+
+  CountStat(StatCounter::Writes, pages.size());
+  size_t run_start = 0;
+  while (run_start < pages.size()) {
+    // free page map的page把文件分成了若干段，一次pwritev不能跨段
+    page_id_t page_id = first_page_id + static_cast<page_id_t>(run_start);
+    size_t run_end = std::min(pages.size(), run_start + PAGES_PER_FREE_MAP - page_id % PAGES_PER_FREE_MAP);
+    std::vector<iovec> iovs(run_end - run_start);
+    for (size_t i = run_start; i < run_end; i++) {
+      iovs[i - run_start].iov_base = const_cast<char *>(pages[i]);
+      iovs[i - run_start].iov_len = BUSTUB_PAGE_SIZE;
+    }
+    {
+      auto timer = TimeStat(StatHistogram::WriteLatency);
+      WriteVectored(&iovs, PageOffset(page_id));
+    }
+    GrowFileSize(PageOffset(page_id) + static_cast<int64_t>(iovs.size()) * BUSTUB_PAGE_SIZE);
+    run_start = run_end;
+  }
+  if (sync_policy_ == DiskSyncPolicy::PerWrite) {
+    SyncData();
+  }
+  promise.set_value();
+  return promise.get_future();
+}
+
+void DiskManager::WriteVectored(std::vector<iovec> *iovs, int64_t offset) {
+  size_t first = 0;
+  while (first < iovs->size()) {
+    // 一次pwritev最多IOV_MAX个buffer，并且可能只写了一部分
+    int count = static_cast<int>(std::min<size_t>(iovs->size() - first, IOV_MAX));
+    ssize_t rc = pwritev(db_fd_, &(*iovs)[first], count, offset);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    offset += rc;
+    while (rc > 0) {
+      auto len = static_cast<ssize_t>((*iovs)[first].iov_len);
+      if (rc < len) {
+        (*iovs)[first].iov_base = static_cast<char *>((*iovs)[first].iov_base) + rc;
+        (*iovs)[first].iov_len -= rc;
+        break;
+      }
+      rc -= len;
+      first++;
+    }
+  }
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  std::promise<void> promise;
+  ReadPage(page_id, page_data);
+  promise.set_value();
+  return promise.get_future();
+}
+
+auto DiskManager::ReadPagesAsync(page_id_t first_page_id, const std::vector<char *> &pages) -> std::future<void> {
+  std::promise<void> promise;
+  if (db_fd_ < 0) {
+    // DiskManagerMemory等子类没有文件，逐个page读
+    for (size_t i = 0; i < pages.size(); i++) {
+      ReadPage(first_page_id + static_cast<page_id_t>(i), pages[i]);
+    }
+    promise.set_value();
+    return promise.get_future();
+  }
+
+  CountStat(StatCounter::Reads, pages.size());
+  size_t run_start = 0;
+  while (run_start < pages.size()) {
+    // 和WritePagesAsync一样，一次preadv不能跨过free page map的page
+    page_id_t page_id = first_page_id + static_cast<page_id_t>(run_start);
+    size_t run_end = std::min(pages.size(), run_start + PAGES_PER_FREE_MAP - page_id % PAGES_PER_FREE_MAP);
+    std::vector<iovec> iovs(run_end - run_start);
+    for (size_t i = run_start; i < run_end; i++) {
+      iovs[i - run_start].iov_base = pages[i];
+      iovs[i - run_start].iov_len = BUSTUB_PAGE_SIZE;
+    }
+    {
+      auto timer = TimeStat(StatHistogram::ReadLatency);
+      ReadVectored(&iovs, PageOffset(page_id));
+    }
+    run_start = run_end;
+  }
+  promise.set_value();
+  return promise.get_future();
+}
+
+void DiskManager::ReadVectored(std::vector<iovec> *iovs, int64_t offset) {
+  size_t first = 0;
+  while (first < iovs->size()) {
+    int count = static_cast<int>(std::min<size_t>(iovs->size() - first, IOV_MAX));
+    ssize_t rc = preadv(db_fd_, &(*iovs)[first], count, offset);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    if (rc == 0) {
+      // 文件结束，剩下的部分填0
+      for (; first < iovs->size(); first++) {
+        memset((*iovs)[first].iov_base, 0, (*iovs)[first].iov_len);
+      }
+      return;
+    }
+    offset += rc;
+    while (rc > 0) {
+      auto len = static_cast<ssize_t>((*iovs)[first].iov_len);
+      if (rc < len) {
+        (*iovs)[first].iov_base = static_cast<char *>((*iovs)[first].iov_base) + rc;
+        (*iovs)[first].iov_len -= rc;
+        break;
+      }
+      rc -= len;
+      first++;
     }
   }
 }
 
+void DiskManager::SyncBatch() {
+  if (sync_policy_ == DiskSyncPolicy::PerBatch) {
+    Sync();
+  }
+}
+
+void DiskManager::Sync() {
+  if (db_fd_ < 0) {
+    return;
+  }
+  WriteFreePageMap();
+  SyncData();
+}
+
+void DiskManager::SyncData() {
+  if (db_fd_ < 0) {
+    return;
+  }
+  WriteFreePageMap(true);
+  CountStat(StatCounter::Syncs);
+  auto timer = TimeStat(StatHistogram::SyncLatency);
+#ifdef __APPLE__
+  if (fsync(db_fd_) != 0) {
+#else
+  if (fdatasync(db_fd_) != 0) {
+#endif
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -131,7 +375,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   assert(log_data != buffer_used);
   buffer_used = log_data;
 
-  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+  if (size == 0) {  // no effect on the number of flushes if log buffer is empty
     return;
   }
 
@@ -142,7 +386,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
     assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
   }
 
-  num_flushes_ += 1;
+  CountStat(StatCounter::LogFlushes);
   // sequence write
   log_io_.write(log_data, size);
 
@@ -184,21 +428,335 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Mark a page as free in the free page map
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot deallocate an invalid page");
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  size_t word = page_id / 64;
+  if (word >= free_map_.size()) {
+    free_map_.resize(word + 1, 0);
+  }
+  uint64_t bit = uint64_t{1} << (page_id % 64);
+  if ((free_map_[word] & bit) == 0) {
+    free_map_[word] |= bit;
+    CountFreePage(page_id, true);
+    MarkFreeMapDirty(page_id);
+  }
+}
+
+/**
+ * Take the lowest free page id below limit that belongs to the given stripe
+ */
+auto DiskManager::AllocateFreePage(page_id_t limit, size_t stride, size_t offset) -> page_id_t {
+  BUSTUB_ASSERT(offset < stride, "offset must be below the stride");
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  // 按stride统计每个stripe的free page数，没有free page的stripe不用扫描bitmap
+  if (stride != stripe_stride_) {
+    stripe_stride_ = stride;
+    stripe_free_pages_.assign(stride, 0);
+    for (size_t word = 0; word < free_map_.size(); word++) {
+      for (uint64_t bits = free_map_[word]; bits != 0; bits &= bits - 1) {
+        stripe_free_pages_[(word * 64 + __builtin_ctzll(bits)) % stride]++;
+      }
+    }
+  }
+  if (stripe_free_pages_[offset] == 0) {
+    return INVALID_PAGE_ID;
+  }
+  size_t num_words = std::min(free_map_.size(), (static_cast<size_t>(limit) + 63) / 64);
+  for (size_t word = 0; word < num_words; word++) {
+    // 跳过没有free page的word，只检查置位的bit
+    uint64_t bits = free_map_[word];
+    while (bits != 0) {
+      auto bit = static_cast<size_t>(__builtin_ctzll(bits));
+      bits &= bits - 1;
+      auto page_id = static_cast<page_id_t>(word * 64 + bit);
+      if (page_id >= limit) {
+        return INVALID_PAGE_ID;
+      }
+      if (page_id % stride == offset) {
+        free_map_[word] &= ~(uint64_t{1} << bit);
+        CountFreePage(page_id, false);
+        MarkFreeMapDirty(page_id, true);
+        return page_id;
+      }
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/**
+ * Make sure a page handed out without the free page map is not also free in it
+ */
+void DiskManager::ClaimPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  size_t word = page_id / 64;
+  uint64_t bit = uint64_t{1} << (page_id % 64);
+  if (word < free_map_.size() && (free_map_[word] & bit) != 0) {
+    free_map_[word] &= ~bit;
+    CountFreePage(page_id, false);
+    MarkFreeMapDirty(page_id, true);
+  }
+}
+
+auto DiskManager::IsPageFree(page_id_t page_id) -> bool {
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  size_t word = page_id / 64;
+  return word < free_map_.size() && (free_map_[word] & (uint64_t{1} << (page_id % 64))) != 0;
+}
+
+auto DiskManager::GetNumFreePages() -> size_t {
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  return num_free_pages_;
+}
+
+auto DiskManager::ReadFilePageSize(const std::string &db_file) -> std::optional<uint32_t> {
+  int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  FileHeader header;
+  FileHeader expected;
+  ssize_t rc = pread(fd, &header, sizeof(header), 0);
+  close(fd);
+  if (rc != static_cast<ssize_t>(sizeof(header)) || memcmp(header.magic_, expected.magic_, sizeof(header.magic_)) != 0) {
+    return std::nullopt;
+  }
+  return header.page_size_;
+}
+
+auto DiskManager::GetNumPages() const -> size_t {
+  // 第一个page是文件头，之后每段开头的page是free page map
+  auto physical_pages = static_cast<size_t>((db_file_size_.load() + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+  if (physical_pages <= 1) {
+    return 0;
+  }
+  physical_pages--;
+  size_t groups = (physical_pages + PAGES_PER_FREE_MAP) / (PAGES_PER_FREE_MAP + 1);
+  return physical_pages - groups;
+}
+
+/**
+ * Offline compaction: drop the free pages at the end of the db file
+ */
+auto DiskManager::TruncateFreeTail() -> size_t {
+  if (db_fd_ < 0) {
+    return 0;
+  }
+  size_t num_pages = GetNumPages();
+  size_t new_num_pages = num_pages;
+  {
+    std::lock_guard<std::mutex> lock(free_map_latch_);
+    while (new_num_pages > 0) {
+      size_t page_id = new_num_pages - 1;
+      size_t word = page_id / 64;
+      if (word >= free_map_.size() || (free_map_[word] & (uint64_t{1} << (page_id % 64))) == 0) {
+        break;
+      }
+      // 截掉的page不再是free page
+      free_map_[word] &= ~(uint64_t{1} << (page_id % 64));
+      CountFreePage(static_cast<page_id_t>(page_id), false);
+      MarkFreeMapDirty(static_cast<page_id_t>(page_id));
+      new_num_pages--;
+    }
+  }
+  if (new_num_pages == num_pages) {
+    return 0;
+  }
+  int64_t new_size = new_num_pages == 0 ? BUSTUB_PAGE_SIZE
+                                       : PageOffset(static_cast<page_id_t>(new_num_pages - 1)) + BUSTUB_PAGE_SIZE;
+  if (ftruncate(db_fd_, new_size) != 0) {
+    LOG_DEBUG("I/O error while truncating");
+    return 0;
+  }
+  db_file_size_ = new_size;
+  {
+    // 完全被截掉的段不需要再写free page map
+    std::lock_guard<std::mutex> lock(free_map_latch_);
+    size_t groups = new_num_pages == 0 ? 0 : (new_num_pages - 1) / PAGES_PER_FREE_MAP + 1;
+    if (free_map_dirty_.size() > groups) {
+      free_map_dirty_.resize(groups);
+      free_map_allocated_.resize(groups);
+    }
+  }
+  Sync();
+  return num_pages - new_num_pages;
+}
+
+auto DiskManager::PageOffset(page_id_t page_id) -> int64_t {
+  // [header] 之后第g段从free page map开始: [map g][page g*M] ... [page g*M+M-1]
+  auto group = static_cast<int64_t>(page_id / PAGES_PER_FREE_MAP);
+  return (static_cast<int64_t>(page_id) + group + 2) * BUSTUB_PAGE_SIZE;
+}
+
+auto DiskManager::FreeMapOffset(size_t group) -> int64_t {
+  return (static_cast<int64_t>(group) * (PAGES_PER_FREE_MAP + 1) + 1) * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManager::ReadOrWriteFileHeader() {
+  std::unique_ptr<char, decltype(&std::free)> buffer_owner(
+      static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE)), &std::free);
+  char *buffer = buffer_owner.get();
+  FileHeader expected;
+  if (db_file_size_.load() == 0) {
+    // 新文件，写入文件头
+    memset(buffer, 0, BUSTUB_PAGE_SIZE);
+    memcpy(buffer, &expected, sizeof(expected));
+    if (pwrite(db_fd_, buffer, BUSTUB_PAGE_SIZE, 0) != BUSTUB_PAGE_SIZE) {
+      close(db_fd_);
+      db_fd_ = -1;
+      throw Exception("can't write db file header");
+    }
+    GrowFileSize(BUSTUB_PAGE_SIZE);
+    return;
+  }
+  FileHeader header;
+  ssize_t rc = pread(db_fd_, &header, sizeof(header), 0);
+  std::string error;
+  if (rc != static_cast<ssize_t>(sizeof(header)) || memcmp(header.magic_, expected.magic_, sizeof(header.magic_)) != 0) {
+    error = fmt::format("{} is not a db file, or was created by an older version", file_name_);
+  } else if (header.version_ != expected.version_) {
+    error = fmt::format("{} has format version {}, expected {}", file_name_, header.version_, expected.version_);
+  } else if (header.page_size_ != expected.page_size_) {
+    error = fmt::format("{} was created with {} byte pages, this build uses {} byte pages", file_name_,
+                        header.page_size_, expected.page_size_);
+  }
+  if (!error.empty()) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception(error);
+  }
+}
+
+void DiskManager::MarkFreeMapDirty(page_id_t page_id, bool allocated) {
+  size_t group = page_id / PAGES_PER_FREE_MAP;
+  if (group >= free_map_dirty_.size()) {
+    free_map_dirty_.resize(group + 1, false);
+    free_map_allocated_.resize(group + 1, false);
+  }
+  free_map_dirty_[group] = true;
+  if (allocated) {
+    free_map_allocated_[group] = true;
+    has_free_map_allocations_.store(true, std::memory_order_release);
+  }
+}
+
+void DiskManager::CountFreePage(page_id_t page_id, bool freed) {
+  if (freed) {
+    num_free_pages_++;
+  } else {
+    num_free_pages_--;
+  }
+  if (stripe_stride_ != 0) {
+    size_t &count = stripe_free_pages_[page_id % stripe_stride_];
+    count = freed ? count + 1 : count - 1;
+  }
+}
+
+void DiskManager::ReadFreePageMap() {
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  int64_t file_size = db_file_size_.load();
+  // 按page对齐，O_DIRECT下也可以直接读写
+  std::unique_ptr<uint64_t, decltype(&std::free)> buffer_owner(
+      static_cast<uint64_t *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE)), &std::free);
+  uint64_t *words = buffer_owner.get();
+  for (size_t group = 0; FreeMapOffset(group) < file_size; group++) {
+    auto *buffer = reinterpret_cast<char *>(words);
+    ssize_t rc = pread(db_fd_, buffer, BUSTUB_PAGE_SIZE, FreeMapOffset(group));
+    if (rc < 0) {
+      LOG_DEBUG("I/O error while reading free page map");
+      rc = 0;
+    }
+    memset(buffer + rc, 0, BUSTUB_PAGE_SIZE - rc);
+    free_map_.resize((group + 1) * WORDS_PER_FREE_MAP, 0);
+    for (size_t i = 0; i < WORDS_PER_FREE_MAP; i++) {
+      free_map_[group * WORDS_PER_FREE_MAP + i] = words[i];
+      num_free_pages_ += __builtin_popcountll(words[i]);
+    }
+  }
+}
+
+void DiskManager::WriteFreePageMap(bool allocations_only) {
+  if (allocations_only && !has_free_map_allocations_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(free_map_latch_);
+  std::unique_ptr<uint64_t, decltype(&std::free)> buffer_owner(
+      static_cast<uint64_t *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE)), &std::free);
+  uint64_t *words = buffer_owner.get();
+  bool allocations_left = false;
+  for (size_t group = 0; group < free_map_dirty_.size(); group++) {
+    if (!free_map_dirty_[group] || (allocations_only && !free_map_allocated_[group])) {
+      continue;
+    }
+    for (size_t i = 0; i < WORDS_PER_FREE_MAP; i++) {
+      size_t word = group * WORDS_PER_FREE_MAP + i;
+      words[i] = word < free_map_.size() ? free_map_[word] : 0;
+    }
+    if (pwrite(db_fd_, words, BUSTUB_PAGE_SIZE, FreeMapOffset(group)) != BUSTUB_PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing free page map");
+      allocations_left = allocations_left || free_map_allocated_[group];
+      continue;
+    }
+    GrowFileSize(FreeMapOffset(group) + BUSTUB_PAGE_SIZE);
+    free_map_dirty_[group] = false;
+    free_map_allocated_[group] = false;
+  }
+  has_free_map_allocations_.store(allocations_left, std::memory_order_release);
+}
+
 /**
  * Returns number of flushes made so far
  */
-auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
+auto DiskManager::GetNumFlushes() const -> int {
+  return static_cast<int>(stats_.Get(static_cast<size_t>(StatCounter::LogFlushes)));
+}
 
 /**
  * Returns number of Writes made so far
  */
-auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
+auto DiskManager::GetNumWrites() const -> int {
+  return static_cast<int>(stats_.Get(static_cast<size_t>(StatCounter::Writes)));
+}
+
+/**
+ * Returns number of fdatasync calls made so far
+ */
+auto DiskManager::GetNumSyncs() const -> int {
+  return static_cast<int>(stats_.Get(static_cast<size_t>(StatCounter::Syncs)));
+}
+
+auto DiskManager::GetStats() const -> DiskManagerStats {
+  DiskManagerStats stats;
+  stats.reads_ = stats_.Get(static_cast<size_t>(StatCounter::Reads));
+  stats.writes_ = stats_.Get(static_cast<size_t>(StatCounter::Writes));
+  stats.syncs_ = stats_.Get(static_cast<size_t>(StatCounter::Syncs));
+  stats.log_flushes_ = stats_.Get(static_cast<size_t>(StatCounter::LogFlushes));
+  stats.read_latency_ = stats_.GetHistogram(static_cast<size_t>(StatHistogram::ReadLatency));
+  stats.write_latency_ = stats_.GetHistogram(static_cast<size_t>(StatHistogram::WriteLatency));
+  stats.sync_latency_ = stats_.GetHistogram(static_cast<size_t>(StatHistogram::SyncLatency));
+  return stats;
+}
+
+void DiskManager::ResetStats() { stats_.Reset(); }
 
 /**
  * Returns true if the log is currently being flushed
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
+/**
+ * Private helper function to update the cached db file size
+ */
+void DiskManager::GrowFileSize(int64_t end) {
+  // 写到了文件末尾之后，更新缓存的文件大小
+  int64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
+  }
+}
+
 /**
  * Private helper function to get disk file size
  */
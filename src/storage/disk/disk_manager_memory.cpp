@@ -35,7 +35,8 @@ DiskManagerMemory::DiskManagerMemory(size_t pages) { memory_ = new char[pages *
 void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
   // set write cursor to offset
-  num_writes_ += 1;
+  CountStat(StatCounter::Writes);
+  auto timer = TimeStat(StatHistogram::WriteLatency);
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
@@ -44,6 +45,8 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
+  CountStat(StatCounter::Reads);
+  auto timer = TimeStat(StatHistogram::ReadLatency);
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
@@ -0,0 +1,419 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring.cpp
+//
+// Identification: src/storage/disk/disk_manager_uring.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_uring.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+namespace {
+
+auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, DiskSyncPolicy sync_policy, bool direct_io,
+                                   uint32_t queue_depth)
+    : DiskManager(db_file, sync_policy) {
+  if (db_fd_ < 0 || !SetUpRing(queue_depth)) {
+    LOG_DEBUG("io_uring is unavailable, falling back to pread/pwrite");
+    return;
+  }
+  if (direct_io) {
+    // tmpfs等文件系统不支持O_DIRECT，这时继续使用page cache
+    int flags = fcntl(db_fd_, F_GETFL);
+    direct_io_ = flags >= 0 && fcntl(db_fd_, F_SETFL, flags | O_DIRECT) == 0;
+  }
+  reaper_thread_ = std::thread([this] { RunReaper(); });
+}
+
+DiskManagerUring::~DiskManagerUring() { TearDownRing(); }
+
+void DiskManagerUring::ShutDown() {
+  TearDownRing();
+  DiskManager::ShutDown();
+}
+
+auto DiskManagerUring::SetUpRing(uint32_t entries) -> bool {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(std::max<uint32_t>(entries, 1), &params);
+  if (ring_fd < 0) {
+    return false;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(ring_fd);
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = cq_ring_ = nullptr;
+    close(ring_fd);
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  sq_entries_ = params.sq_entries;
+  ring_fd_ = ring_fd;
+  return true;
+}
+
+void DiskManagerUring::TearDownRing() {
+  if (ring_fd_ < 0) {
+    return;
+  }
+  {
+    // 提交一个NOP唤醒reaper，reaper在所有I/O完成之后退出
+    std::lock_guard<std::mutex> lock(submit_latch_);
+    stop_ = true;
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (IoUringEnter(ring_fd_, 1, 0, 0) < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+    }
+  }
+  reaper_thread_.join();
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+void DiskManagerUring::WritePage(page_id_t page_id, const char *page_data) {
+  if (ring_fd_ < 0) {
+    DiskManager::WritePage(page_id, page_data);
+    return;
+  }
+  WritePageAsync(page_id, page_data).wait();
+}
+
+void DiskManagerUring::ReadPage(page_id_t page_id, char *page_data) {
+  if (ring_fd_ < 0) {
+    DiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  ReadPageAsync(page_id, page_data).wait();
+}
+
+auto DiskManagerUring::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  if (ring_fd_ < 0) {
+    return DiskManager::WritePageAsync(page_id, page_data);
+  }
+  CountStat(StatCounter::Writes);
+  // 写请求不会修改这个buffer
+  return Submit(true, page_id, const_cast<char *>(page_data));
+}
+
+auto DiskManagerUring::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  if (ring_fd_ < 0) {
+    return DiskManager::ReadPageAsync(page_id, page_data);
+  }
+  CountStat(StatCounter::Reads);
+  return Submit(false, page_id, page_data);
+}
+
+auto DiskManagerUring::WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages)
+    -> std::future<void> {
+  if (ring_fd_ < 0) {
+    return DiskManager::WritePagesAsync(first_page_id, pages);
+  }
+  std::vector<std::future<void>> writes;
+  writes.reserve(pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    writes.push_back(WritePageAsync(first_page_id + static_cast<page_id_t>(i), pages[i]));
+  }
+  return std::async(std::launch::deferred, [writes = std::move(writes)]() mutable {
+    for (auto &write : writes) {
+      write.wait();
+    }
+  });
+}
+
+auto DiskManagerUring::ReadPagesAsync(page_id_t first_page_id, const std::vector<char *> &pages) -> std::future<void> {
+  if (ring_fd_ < 0) {
+    return DiskManager::ReadPagesAsync(first_page_id, pages);
+  }
+  std::vector<std::future<void>> reads;
+  reads.reserve(pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    reads.push_back(ReadPageAsync(first_page_id + static_cast<page_id_t>(i), pages[i]));
+  }
+  return std::async(std::launch::deferred, [reads = std::move(reads)]() mutable {
+    for (auto &read : reads) {
+      read.wait();
+    }
+  });
+}
+
+auto DiskManagerUring::Submit(bool is_write, page_id_t page_id, char *page_data) -> std::future<void> {
+  auto request = std::make_unique<Request>();
+  request->is_write_ = is_write;
+  request->page_id_ = page_id;
+  request->data_ = page_data;
+  request->start_ = std::chrono::steady_clock::now();
+  if (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE != 0) {
+    // O_DIRECT要求buffer按page对齐
+    request->bounce_ = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+    if (is_write) {
+      memcpy(request->bounce_, page_data, BUSTUB_PAGE_SIZE);
+    }
+  }
+  auto future = request->promise_.get_future();
+
+  std::unique_lock<std::mutex> lock(submit_latch_);
+  // 限制in-flight的I/O数量，保证submission ring不会溢出
+  slot_cv_.wait(lock, [this] { return in_flight_ < sq_entries_; });
+  in_flight_++;
+  Request *pushed = request.release();
+  if (!PushRequest(pushed)) {
+    lock.unlock();
+    FinishWithoutRing(pushed);
+  }
+  return future;
+}
+
+auto DiskManagerUring::PushRequest(Request *request) -> bool {
+  char *buffer = request->bounce_ != nullptr ? request->bounce_ : request->data_;
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  // 使用readv/writev，兼容没有IORING_OP_READ/WRITE的内核
+  request->iov_.iov_base = buffer + request->done_;
+  request->iov_.iov_len = BUSTUB_PAGE_SIZE - request->done_;
+  sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = db_fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+  sqe->len = 1;
+  sqe->off = static_cast<uint64_t>(PageOffset(request->page_id_)) + request->done_;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (IoUringEnter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG_DEBUG("I/O error while submitting to io_uring: %s", strerror(errno));
+      // 内核没有取走这个sqe就收回来，否则它永远不会完成，等待它的线程会一直阻塞
+      if (__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == tail) {
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        return false;
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+void DiskManagerUring::FinishWithoutRing(Request *request) {
+  char *buffer = request->bounce_ != nullptr ? request->bounce_ : request->data_;
+  std::vector<iovec> iovs{{buffer + request->done_, BUSTUB_PAGE_SIZE - request->done_}};
+  auto offset = PageOffset(request->page_id_) + static_cast<int64_t>(request->done_);
+  if (request->is_write_) {
+    WriteVectored(&iovs, offset);
+    GrowFileSize(PageOffset(request->page_id_) + BUSTUB_PAGE_SIZE);
+    if (sync_policy_ == DiskSyncPolicy::PerWrite) {
+      SyncData();
+    }
+  } else {
+    ReadVectored(&iovs, offset);
+  }
+  CompleteRequest(request);
+}
+
+void DiskManagerUring::CompleteRequest(Request *request) {
+  if (request->bounce_ != nullptr) {
+    if (!request->is_write_) {
+      memcpy(request->data_, request->bounce_, BUSTUB_PAGE_SIZE);
+    }
+    std::free(request->bounce_);
+  }
+  // 从提交到完成的延迟
+  auto histogram = request->is_write_ ? StatHistogram::WriteLatency : StatHistogram::ReadLatency;
+  stats_.RecordLatency(static_cast<size_t>(histogram), std::chrono::steady_clock::now() - request->start_);
+  request->promise_.set_value();
+  delete request;
+  {
+    std::lock_guard<std::mutex> lock(submit_latch_);
+    in_flight_--;
+  }
+  slot_cv_.notify_one();
+}
+
+void DiskManagerUring::RunReaper() {
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      {
+        std::lock_guard<std::mutex> lock(submit_latch_);
+        if (stop_ && in_flight_ == 0) {
+          return;
+        }
+      }
+      if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+        LOG_DEBUG("I/O error while waiting for io_uring");
+      }
+      continue;
+    }
+    io_uring_cqe cqe = cqes_[head & *cq_mask_];
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    auto *request = reinterpret_cast<Request *>(cqe.user_data);
+    if (request == nullptr) {
+      // 关闭时提交的NOP
+      continue;
+    }
+
+    if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+      std::unique_lock<std::mutex> lock(submit_latch_);
+      if (!PushRequest(request)) {
+        lock.unlock();
+        FinishWithoutRing(request);
+      }
+      continue;
+    }
+    if (cqe.res < 0) {
+      LOG_DEBUG("I/O error in io_uring request: %s", strerror(-cqe.res));
+      CompleteRequest(request);
+      continue;
+    }
+    if (cqe.res == 0) {
+      if (request->is_write_) {
+        LOG_DEBUG("I/O error while writing");
+        CompleteRequest(request);
+        continue;
+      }
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      char *buffer = request->bounce_ != nullptr ? request->bounce_ : request->data_;
+      memset(buffer + request->done_, 0, BUSTUB_PAGE_SIZE - request->done_);
+      request->done_ = BUSTUB_PAGE_SIZE;
+    }
+    request->done_ += cqe.res;
+    if (request->done_ < BUSTUB_PAGE_SIZE) {
+      // 只完成了一部分，继续提交剩下的部分
+      std::unique_lock<std::mutex> lock(submit_latch_);
+      if (!PushRequest(request)) {
+        lock.unlock();
+        FinishWithoutRing(request);
+      }
+      continue;
+    }
+    if (request->is_write_) {
+      GrowFileSize(PageOffset(request->page_id_) + BUSTUB_PAGE_SIZE);
+      if (sync_policy_ == DiskSyncPolicy::PerWrite) {
+        SyncData();
+      }
+    }
+    CompleteRequest(request);
+  }
+}
+
+#else
+
+DiskManagerUring::DiskManagerUring(const std::string &db_file, DiskSyncPolicy sync_policy, bool direct_io,
+                                   uint32_t queue_depth)
+    : DiskManager(db_file, sync_policy) {
+  LOG_DEBUG("io_uring is unavailable, falling back to pread/pwrite");
+}
+
+DiskManagerUring::~DiskManagerUring() = default;
+
+void DiskManagerUring::ShutDown() { DiskManager::ShutDown(); }
+
+void DiskManagerUring::WritePage(page_id_t page_id, const char *page_data) {
+  DiskManager::WritePage(page_id, page_data);
+}
+
+void DiskManagerUring::ReadPage(page_id_t page_id, char *page_data) { DiskManager::ReadPage(page_id, page_data); }
+
+auto DiskManagerUring::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  return DiskManager::WritePageAsync(page_id, page_data);
+}
+
+auto DiskManagerUring::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  return DiskManager::ReadPageAsync(page_id, page_data);
+}
+
+auto DiskManagerUring::WritePagesAsync(page_id_t first_page_id, const std::vector<const char *> &pages)
+    -> std::future<void> {
+  return DiskManager::WritePagesAsync(first_page_id, pages);
+}
+
+auto DiskManagerUring::ReadPagesAsync(page_id_t first_page_id, const std::vector<char *> &pages) -> std::future<void> {
+  return DiskManager::ReadPagesAsync(first_page_id, pages);
+}
+
+#endif
+
+}  // namespace bustub
@@ -10,13 +10,15 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          BPlusTreeProtocol protocol)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      header_page_id_(header_page_id),
+      protocol_(protocol) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
@@ -29,7 +31,22 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
   ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
   auto root_page = guard.template As<BPlusTreeHeaderPage>();
-  return (root_page->root_page_id_ == INVALID_PAGE_ID);
+  if (root_page->root_page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  // B-link树不合并节点，可能只剩下空的叶节点
+  guard = bpm_->FetchPageRead(root_page->root_page_id_);
+  while (!guard.template As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm_->FetchPageRead(guard.template As<InternalPage>()->ValueAt(0));
+  }
+  while (guard.template As<LeafPage>()->GetSize() == 0) {
+    page_id_t next_page_id = guard.template As<LeafPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    guard = bpm_->FetchPageRead(next_page_id);
+  }
+  return false;
 }
 /*****************************************************************************
  * SEARCH
@@ -41,19 +58,34 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  if (optimistic_reads_) {
+    for (int attempt = 0; attempt < BPLUSTREE_OPTIMISTIC_RETRIES; attempt++) {
+      ValueType value;
+      bool found;
+      if (TryGetValueOptimistic(key, &value, &found)) {
+        if (found) {
+          result->push_back(value);
+        }
+        return found;
+      }
+    }
+    // 冲突太多，加读锁查询
+  }
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_, AccessType::Get);
   auto root_page = guard.template As<BPlusTreeHeaderPage>();
   if (root_page->root_page_id_ == INVALID_PAGE_ID) {
     // 树是空的
     return false;
   }
-  guard = bpm_->FetchPageRead(root_page->root_page_id_);
+  guard = bpm_->FetchPageRead(root_page->root_page_id_, AccessType::Get);
+  MoveRight(&guard, key);
   auto page = guard.template As<BPlusTreePage>();
   while (!page->IsLeafPage()) {
     // 顺着内部节点查询
     auto internal_page = guard.template As<InternalPage>();
     page_id_t page_id = internal_page->InternalFind(key, comparator_);
-    guard = bpm_->FetchPageRead(page_id);
+    guard = bpm_->FetchPageRead(page_id, AccessType::Get);
+    MoveRight(&guard, key);
     page = guard.template As<BPlusTreePage>();
   }
   // 查找到叶节点
@@ -67,6 +99,66 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return false;
 }
 
+/*
+ * Optimistic lock coupling: pages are neither pinned nor latched, so a lookup
+ * writes no shared state. The version of a page is read before its content
+ * and validated after it, and the parent is validated once the child version
+ * is known, so the child page id read from the parent was still current.
+ * Writers make the version odd while they hold the write latch, and the buffer
+ * pool manager changes it when it reuses the frame for another page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryGetValueOptimistic(const KeyType &key, ValueType *value, bool *found) -> bool {
+  page_id_t parent_page_id = header_page_id_;
+  uint64_t parent_version;
+  const Page *parent = bpm_->ReadPageOptimistic(parent_page_id, &parent_version);
+  if (parent == nullptr) {
+    // 不在buffer pool中，先读进来再重试
+    bpm_->FetchPageBasic(parent_page_id, AccessType::Get);
+    return false;
+  }
+  page_id_t page_id = reinterpret_cast<const BPlusTreeHeaderPage *>(parent->GetData())->root_page_id_;
+  if (!bpm_->ValidateOptimistic(parent, parent_page_id, parent_version)) {
+    return false;
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    // 树是空的
+    *found = false;
+    return true;
+  }
+  while (true) {
+    uint64_t version;
+    const Page *page = bpm_->ReadPageOptimistic(page_id, &version);
+    if (page == nullptr) {
+      bpm_->FetchPageBasic(page_id, AccessType::Get);
+      return false;
+    }
+    if (!bpm_->ValidateOptimistic(parent, parent_page_id, parent_version)) {
+      return false;
+    }
+    parent = page;
+    parent_page_id = page_id;
+    parent_version = version;
+    // 没有加锁，page的内容可能正在被修改，size越界时直接重试
+    auto tree_page = reinterpret_cast<const BPlusTreePage *>(page->GetData());
+    int size = tree_page->GetSize();
+    if (tree_page->IsLeafPage() ? size < 0 || size > leaf_max_size_ : size < 2 || size > internal_max_size_) {
+      return false;
+    }
+    page_id = RightPageFor(tree_page, key);
+    if (page_id == INVALID_PAGE_ID) {
+      if (tree_page->IsLeafPage()) {
+        *found = reinterpret_cast<const LeafPage *>(page->GetData())->LeafFind(key, comparator_, value);
+        return bpm_->ValidateOptimistic(parent, parent_page_id, parent_version);
+      }
+      page_id = reinterpret_cast<const InternalPage *>(page->GetData())->InternalFind(key, comparator_);
+    }
+    if (!bpm_->ValidateOptimistic(parent, parent_page_id, parent_version)) {
+      return false;
+    }
+  }
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -76,14 +168,36 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * entry, otherwise insert into leaf page.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
+ * The first attempt descends with read latches and write-latches only the
+ * leaf. If the leaf could split, the insert starts over with write latches,
+ * releasing the ancestors of every page that cannot split.
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
+  if (protocol_ == BPlusTreeProtocol::BLink) {
+    return InsertBLink(key, value);
+  }
+  {
+    // 乐观插入：读锁下降，叶节点不会分裂时只修改叶节点
+    Context ctx;
+    auto leaf_guard = FetchLeafOptimistic(key, ctx);
+    if (leaf_guard.has_value()) {
+      auto leaf_page = leaf_guard->template As<LeafPage>();
+      ValueType find_value;
+      if (leaf_page->LeafFind(key, comparator_, &find_value)) {
+        return false;
+      }
+      if (IsInsertSafe(leaf_page)) {
+        leaf_guard->template AsMut<LeafPage>()->Add(key, value, comparator_);
+        return true;
+      }
+    }
+  }
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   if (root_page->root_page_id_ == INVALID_PAGE_ID) {
     // B+树是空的，插入第一条数据，创建一个新page
-    bpm_->NewPageGuarded(&root_page->root_page_id_);
+    NewTreePage(&root_page->root_page_id_);
     // 创建leaf node
     WritePageGuard leaf_guard = bpm_->FetchPageWrite(root_page->root_page_id_);
     auto leaf_page = leaf_guard.template AsMut<LeafPage>();
@@ -100,6 +214,10 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   guard = bpm_->FetchPageWrite(root_page->root_page_id_);
   auto page = guard.AsMut<BPlusTreePage>();
   while (!page->IsLeafPage()) {
+    // 当前节点不会分裂时，释放header page和所有祖先节点
+    if (IsInsertSafe(page)) {
+      ReleaseAncestors(ctx);
+    }
     // 顺着内部节点查询
     auto internal_page = guard.template As<InternalPage>();
     page_id_t page_id = internal_page->InternalFind(key, comparator_);
@@ -109,6 +227,9 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   }
   // 查找到叶节点
   auto leaf_page = guard.template AsMut<LeafPage>();
+  if (IsInsertSafe(leaf_page)) {
+    ReleaseAncestors(ctx);
+  }
   ValueType find_value;
   if (leaf_page->LeafFind(key, comparator_, &find_value)) {
     // 该key已经存在
@@ -121,12 +242,65 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   return true;
 }
 
+/*
+ * Insert key & value pairs sorted by key. The leaf of the first pending key
+ * is write-latched once and takes every following key below its high key as
+ * long as it cannot split. A key that would split the leaf goes through
+ * Insert, then the next key descends again, usually into the new sibling.
+ * @return: the number of pairs inserted, duplicate keys are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBatch(const std::vector<std::pair<KeyType, ValueType>> &entries, Transaction *txn)
+    -> size_t {
+  size_t inserted = 0;
+  size_t i = 0;
+  while (i < entries.size()) {
+    std::optional<WritePageGuard> leaf_guard;
+    if (protocol_ == BPlusTreeProtocol::BLink) {
+      page_id_t leaf_page_id = DescendBLink(entries[i].first, nullptr);
+      if (leaf_page_id != INVALID_PAGE_ID) {
+        leaf_guard = bpm_->FetchPageWrite(leaf_page_id);
+        MoveRight(&*leaf_guard, entries[i].first);
+      }
+    } else {
+      Context ctx;
+      leaf_guard = FetchLeafOptimistic(entries[i].first, ctx);
+    }
+    if (leaf_guard.has_value()) {
+      auto leaf_page = leaf_guard->template AsMut<LeafPage>();
+      // 后面的key只要还在这个叶节点的范围内，并且叶节点不会分裂，就直接加入
+      while (i < entries.size() && !leaf_page->IsBeyondHighKey(entries[i].first, comparator_)) {
+        ValueType find_value;
+        if (!leaf_page->LeafFind(entries[i].first, comparator_, &find_value)) {
+          if (!IsInsertSafe(leaf_page)) {
+            break;
+          }
+          leaf_page->Add(entries[i].first, entries[i].second, comparator_);
+          inserted++;
+        }
+        i++;
+      }
+      if (i == entries.size() || leaf_page->IsBeyondHighKey(entries[i].first, comparator_)) {
+        // 下一个key属于右边的叶节点，重新下降
+        continue;
+      }
+      leaf_guard.reset();
+    }
+    // 树是空的或者叶节点要分裂，按一般的插入处理
+    if (Insert(entries[i].first, entries[i].second, txn)) {
+      inserted++;
+    }
+    i++;
+  }
+  return inserted;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::SplitLeafNode(Context &ctx, WritePageGuard &guard) {
   auto leaf_page = guard.template AsMut<LeafPage>();
   // 新建leaf node
   page_id_t new_page_id;
-  BasicPageGuard new_guard = bpm_->NewPageGuarded(&new_page_id);
+  BasicPageGuard new_guard = NewTreePage(&new_page_id);
   auto new_leaf_page = new_guard.template AsMut<LeafPage>();
   new_leaf_page->Init(leaf_max_size_);
   new_leaf_page->SetNextPageId(INVALID_PAGE_ID);
@@ -139,7 +313,7 @@ void BPLUSTREE_TYPE::SplitLeafNode(Context &ctx, WritePageGuard &guard) {
     // 根叶节点满了
     // 新建parent node作为新的root node
     page_id_t new_root_id;
-    BasicPageGuard new_root_guard = bpm_->NewPageGuarded(&new_root_id);
+    BasicPageGuard new_root_guard = NewTreePage(&new_root_id);
     auto new_root_page = new_root_guard.template AsMut<InternalPage>();
     new_root_page->Init(internal_max_size_);
     new_root_page->Add(leaf_page->KeyAt(0), guard.PageId(), comparator_);
@@ -152,10 +326,7 @@ void BPLUSTREE_TYPE::SplitLeafNode(Context &ctx, WritePageGuard &guard) {
     // 获取parent节点
     WritePageGuard parent_guard = std::move(ctx.write_set_.back());
     ctx.write_set_.pop_back();
-    // 更新old_page_id的key
-    auto parent_page = parent_guard.template AsMut<InternalPage>();
-    int index = parent_page->ValueIndex(guard.PageId());
-    parent_page->SetKeyAt(index, leaf_page->KeyAt(0));
+    // old page的key仍是它的下界，不需要更新
     KeyType new_page_key = new_leaf_page->KeyAt(0);
     // 把children page释放掉
     guard.Drop();
@@ -172,23 +343,24 @@ void BPLUSTREE_TYPE::InsertIntoInternalNode(WritePageGuard &guard, const KeyType
   if (page->GetSize() == page->GetMaxSize()) {
     // 新建internal node
     page_id_t new_internal_page_id;
-    BasicPageGuard new_internal_guard = bpm_->NewPageGuarded(&new_internal_page_id);
+    BasicPageGuard new_internal_guard = NewTreePage(&new_internal_page_id);
     auto new_internal_page = new_internal_guard.template AsMut<InternalPage>();
     new_internal_page->Init(internal_max_size_);
     // Redistribute internal page
     InternalPage::RedistributeWithInsert(page, new_internal_page, key, page_id, comparator_);
-    // 检查是否为根节点
-    auto root_page = ctx.header_page_->AsMut<BPlusTreeHeaderPage>();
-    if (guard.PageId() == root_page->root_page_id_) {
+    new_internal_page->SetNextPageId(page->GetNextPageId());
+    page->SetNextPageId(new_internal_page_id);
+    // 检查是否为根节点，根节点分裂时header page一定还没有释放
+    if (ctx.IsRootPage(guard.PageId())) {
       // 新建parent node作为新的root node
       page_id_t new_root_id;
-      BasicPageGuard new_root_guard = bpm_->NewPageGuarded(&new_root_id);
+      BasicPageGuard new_root_guard = NewTreePage(&new_root_id);
       auto new_root_page = new_root_guard.template AsMut<InternalPage>();
       new_root_page->Init(internal_max_size_);
       new_root_page->Add(page->KeyAt(0), guard.PageId(), comparator_);
       new_root_page->Add(new_internal_page->KeyAt(0), new_internal_guard.PageId(), comparator_);
       // 修改root值
-      root_page = ctx.header_page_->template AsMut<BPlusTreeHeaderPage>();
+      auto root_page = ctx.header_page_->template AsMut<BPlusTreeHeaderPage>();
       root_page->root_page_id_ = new_root_id;
     } else {
       // 获取parent节点
@@ -210,6 +382,107 @@ void BPLUSTREE_TYPE::InsertIntoInternalNode(WritePageGuard &guard, const KeyType
   }
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Sort the entries and build the tree bottom-up: the leaves are filled from
+ * left to right, then every level of internal pages is built from the first
+ * keys of the level below until a single page is left, which becomes the
+ * root. Pages are linked to their right sibling and take its first key as
+ * their high key, as a split would have left them. The header page stays
+ * write-latched until the root is set, so no one sees a half-built tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries, double fill_factor) -> bool {
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto header_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+  if (header_page->root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+  if (entries.empty()) {
+    return true;
+  }
+  // 稳定排序，重复的key只保留第一个
+  std::stable_sort(entries.begin(), entries.end(),
+                   [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+  auto last = std::unique(entries.begin(), entries.end(),
+                          [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) == 0; });
+  entries.erase(last, entries.end());
+
+  // 当前层每个page的第一个key和page id，是上一层的元素
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  {
+    // 叶节点最多放leaf_max_size_ - 1个元素，放满就会分裂
+    auto sizes = BulkLoadPageSizes(entries.size(), leaf_max_size_ - 1, leaf_max_size_ / 2, fill_factor);
+    level.reserve(sizes.size());
+    BasicPageGuard prev_guard;
+    LeafPage *prev_page = nullptr;
+    size_t next = 0;
+    for (int size : sizes) {
+      page_id_t page_id;
+      BasicPageGuard guard = NewTreePage(&page_id);
+      auto leaf_page = guard.template AsMut<LeafPage>();
+      leaf_page->Init(leaf_max_size_);
+      for (int i = 0; i < size; i++, next++) {
+        leaf_page->Append(entries[next].first, entries[next].second);
+      }
+      if (prev_page != nullptr) {
+        prev_page->SetNextPageId(page_id);
+        prev_page->SetHighKey(leaf_page->KeyAt(0));
+      }
+      level.emplace_back(leaf_page->KeyAt(0), page_id);
+      prev_guard = std::move(guard);
+      prev_page = leaf_page;
+    }
+  }
+  while (level.size() > 1) {
+    auto sizes = BulkLoadPageSizes(level.size(), internal_max_size_, (internal_max_size_ + 1) / 2, fill_factor);
+    std::vector<std::pair<KeyType, page_id_t>> upper_level;
+    upper_level.reserve(sizes.size());
+    BasicPageGuard prev_guard;
+    InternalPage *prev_page = nullptr;
+    size_t next = 0;
+    for (int size : sizes) {
+      page_id_t page_id;
+      BasicPageGuard guard = NewTreePage(&page_id);
+      auto internal_page = guard.template AsMut<InternalPage>();
+      internal_page->Init(internal_max_size_);
+      // key按顺序加入，索引0的key是这个page的下界
+      for (int i = 0; i < size; i++, next++) {
+        internal_page->Add(level[next].first, level[next].second, comparator_);
+      }
+      if (prev_page != nullptr) {
+        prev_page->SetNextPageId(page_id);
+        prev_page->SetHighKey(internal_page->KeyAt(0));
+      }
+      upper_level.emplace_back(internal_page->KeyAt(0), page_id);
+      prev_guard = std::move(guard);
+      prev_page = internal_page;
+    }
+    level = std::move(upper_level);
+  }
+  header_page->root_page_id_ = level[0].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadPageSizes(size_t count, int max_entries, int min_entries, double fill_factor) const
+    -> std::vector<int> {
+  min_entries = std::max(min_entries, 1);
+  int target = std::clamp(static_cast<int>(max_entries * fill_factor), min_entries, max_entries);
+  size_t pages = (count + target - 1) / target;
+  // 元素平均分给每个page，最后一个page也不能低于min_entries
+  if (pages > 1 && count / pages < static_cast<size_t>(min_entries)) {
+    pages = count / min_entries;
+  }
+  std::vector<int> sizes(pages, static_cast<int>(count / pages));
+  for (size_t i = 0; i < count % pages; i++) {
+    sizes[i]++;
+  }
+  return sizes;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -219,9 +492,34 @@ void BPLUSTREE_TYPE::InsertIntoInternalNode(WritePageGuard &guard, const KeyType
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * Like Insert, the first attempt only write-latches the leaf. The key of a
+ * child in its parent is a lower bound of the child, so removing the smallest
+ * key of a leaf never has to update the ancestors.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
+  if (protocol_ == BPlusTreeProtocol::BLink) {
+    RemoveBLink(key);
+    return;
+  }
+  {
+    // 乐观删除：读锁下降，叶节点不会合并时只修改叶节点
+    Context ctx;
+    auto leaf_guard = FetchLeafOptimistic(key, ctx);
+    if (!leaf_guard.has_value()) {
+      // 树是空的
+      return;
+    }
+    auto leaf_page = leaf_guard->template As<LeafPage>();
+    ValueType find_value;
+    if (!leaf_page->LeafFind(key, comparator_, &find_value)) {
+      return;
+    }
+    if (IsRemoveSafe(leaf_page, ctx.IsRootPage(leaf_guard->PageId()))) {
+      leaf_guard->template AsMut<LeafPage>()->Remove(key, comparator_);
+      return;
+    }
+  }
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   if (root_page->root_page_id_ == INVALID_PAGE_ID) {
@@ -236,6 +534,10 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   guard = bpm_->FetchPageWrite(root_page->root_page_id_);
   auto page = guard.AsMut<BPlusTreePage>();
   while (!page->IsLeafPage()) {
+    // 当前节点不会合并时，释放header page和所有祖先节点
+    if (IsRemoveSafe(page, ctx.IsRootPage(guard.PageId()))) {
+      ReleaseAncestors(ctx);
+    }
     // 顺着内部节点查询
     auto internal_page = guard.template As<InternalPage>();
     page_id_t page_id = internal_page->InternalFind(key, comparator_);
@@ -245,6 +547,9 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
   }
   // 查找到叶节点
   auto leaf_page = guard.template AsMut<LeafPage>();
+  if (IsRemoveSafe(leaf_page, ctx.IsRootPage(guard.PageId()))) {
+    ReleaseAncestors(ctx);
+  }
   ValueType find_value;
   if (!leaf_page->LeafFind(key, comparator_, &find_value)) {
     // 该key不存在
@@ -256,10 +561,11 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     if (leaf_page->GetSize() == 0) {
       // 删除page，将root page设置为invalid
       page_id_t page_id = guard.PageId();
-      bpm_->DeletePage(page_id);
       root_page = ctx.header_page_->template AsMut<BPlusTreeHeaderPage>();
       root_page->root_page_id_ = INVALID_PAGE_ID;
+      // unpin之后才能删除page
       guard.Drop();
+      DeleteTreePage(page_id);
     }
     return;
   }
@@ -291,17 +597,15 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
     if (leaf_sibling_page->GetSize() + leaf_page->GetSize() < leaf_page->GetMaxSize()) {
       // merge
       LeafPage::LeafMerge(leaf_page, leaf_sibling_page);
-      // 删除sibling page
       page_id_t sibling_page_id = leaf_sibling_guard.PageId();
-      bpm_->DeletePage(sibling_page_id);
       // 更新parent page
       int leaf_sibling_index = parent_page->ValueIndex(leaf_sibling_guard.PageId());
       KeyType sibling_key = parent_page->KeyAt(leaf_sibling_index);
       parent_page->Remove(sibling_key, comparator_);
-      int leaf_index = parent_page->ValueIndex(leaf_guard.PageId());
-      parent_page->SetKeyAt(leaf_index, leaf_page->KeyAt(0));
       leaf_sibling_guard.Drop();
       leaf_guard.Drop();
+      // 删除sibling page
+      DeleteTreePage(sibling_page_id);
       // 检查internal page是否小于min size
       while (parent_page->GetSize() < parent_page->GetMinSize()) {
         // 根节点不需要在意min size，大小为1时删除
@@ -312,8 +616,8 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
             root_page->root_page_id_ = parent_page->ValueAt(0);
             // 删除原有根节点
             page_id_t old_page_id = parent_guard.PageId();
-            bpm_->DeletePage(old_page_id);
             parent_guard.Drop();
+            DeleteTreePage(old_page_id);
           }
           return;
         }
@@ -340,82 +644,262 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
         }
         internal_page = internal_guard.template AsMut<InternalPage>();
         auto internal_sibling_page = internal_sibling_guard.template AsMut<InternalPage>();
+        // 索引0的key只是下界，合并或移动前换成parent中的key
+        internal_page->SetKeyAt(0, parent_page->KeyAt(parent_page->ValueIndex(internal_guard.PageId())));
+        internal_sibling_page->SetKeyAt(0, parent_page->KeyAt(parent_page->ValueIndex(internal_sibling_guard.PageId())));
 
         if (internal_page->GetSize() + internal_sibling_page->GetSize() <= internal_page->GetMaxSize()) {
           // internal page merge
           InternalPage::InternalMerge(internal_page, internal_sibling_page);
-          // 删除sibling page
-          bpm_->DeletePage(internal_sibling_page_id);
           // 更新parent page
           int internal_sibling_index = parent_page->ValueIndex(internal_sibling_guard.PageId());
           KeyType internal_sibling_key = parent_page->KeyAt(internal_sibling_index);
           internal_sibling_guard.Drop();
+          // 删除sibling page
+          DeleteTreePage(internal_sibling_page_id);
           parent_page->Remove(internal_sibling_key, comparator_);
-          int internal_index = parent_page->ValueIndex(internal_guard.PageId());
-          parent_page->SetKeyAt(internal_index, internal_page->KeyAt(0));
         } else {
           InternalPage::MoveOneKey(internal_page, internal_sibling_page);
           // 更新parent
           int internal_sibling_index = parent_page->ValueIndex(internal_sibling_guard.PageId());
           parent_page->SetKeyAt(internal_sibling_index, internal_sibling_page->KeyAt(0));
-          int internal_index = parent_page->ValueIndex(internal_guard.PageId());
-          parent_page->SetKeyAt(internal_index, internal_page->KeyAt(0));
-          // 释放children
-          internal_guard.Drop();
-          internal_sibling_guard.Drop();
-          // 递归更新
-          if (parent_guard.PageId() != ctx.root_page_id_) {
-            UpdateInternalNode(std::move(parent_guard), ctx);
-          }
           return;
         }
       }
       return;
     }
-    // move 1 key from sibling page
+    // move 1 key from sibling page，只有右边节点的下界改变了
     LeafPage::MoveOneKey(leaf_page, leaf_sibling_page);
-    // 更新parent
     int sibling_index = parent_page->ValueIndex(leaf_sibling_guard.PageId());
     parent_page->SetKeyAt(sibling_index, leaf_sibling_page->KeyAt(0));
-    index = parent_page->ValueIndex(leaf_guard.PageId());
-    parent_page->SetKeyAt(index, leaf_page->KeyAt(0));
-    // 递归更新
-    UpdateInternalNode(std::move(parent_guard), ctx);
-    return;
   }
-  // 获取parent节点
-  WritePageGuard parent_guard = std::move(ctx.write_set_.back());
-  ctx.write_set_.pop_back();
-  // 更新old_page_id的key
-  auto parent_page = parent_guard.template AsMut<InternalPage>();
-  int index = parent_page->ValueIndex(guard.PageId());
-  if (comparator_(parent_page->KeyAt(index), leaf_page->KeyAt(0)) != 0) {
-    parent_page->SetKeyAt(index, leaf_page->KeyAt(0));
-    guard.Drop();
-    UpdateInternalNode(std::move(parent_guard), ctx);
+  // 删除叶节点的最小key后parent中的key仍是它的下界，不需要向上更新
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchLeafOptimistic(const KeyType &key, Context &ctx) -> std::optional<WritePageGuard> {
+  ReadPageGuard parent_guard = bpm_->FetchPageRead(header_page_id_);
+  ctx.root_page_id_ = parent_guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (ctx.root_page_id_ == INVALID_PAGE_ID) {
+    return std::nullopt;
   }
+  page_id_t page_id = ctx.root_page_id_;
+  while (true) {
+    ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+    if (guard.template As<BPlusTreePage>()->IsLeafPage()) {
+      auto leaf_guard = guard.TryUpgrade();
+      if (!leaf_guard.has_value()) {
+        // 有其他writer，放开读锁再等写锁；parent的读锁保证叶节点不会被分裂或合并
+        guard.Drop();
+        leaf_guard = bpm_->FetchPageWrite(page_id);
+      }
+      return leaf_guard;
+    }
+    page_id = guard.template As<InternalPage>()->InternalFind(key, comparator_);
+    parent_guard = std::move(guard);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsInsertSafe(const BPlusTreePage *page) const -> bool {
+  // 叶节点满了就分裂，internal节点满了之后再插入才分裂
+  if (page->IsLeafPage()) {
+    return page->GetSize() + 1 < page->GetMaxSize();
+  }
+  return page->GetSize() < page->GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsRemoveSafe(const BPlusTreePage *page, bool is_root) const -> bool {
+  // 根节点变空，或者根internal节点只剩一个child时要修改header page
+  if (is_root) {
+    return page->GetSize() > (page->IsLeafPage() ? 1 : 2);
+  }
+  return page->GetSize() > page->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseAncestors(Context &ctx) {
+  // 从上往下释放
+  ctx.header_page_ = std::nullopt;
+  ctx.write_set_.clear();
+}
+
+/*****************************************************************************
+ * B-LINK TREE
+ *****************************************************************************/
+/*
+ * Lehman-Yao insertion: descend holding one read latch at a time and write
+ * latch the leaf. A full page is split into a new right sibling that takes
+ * over its high key and right link, and the page is released as soon as the
+ * sibling is linked. Readers that reach the page before the parent knows the
+ * sibling follow the right link. The separator is then inserted into the
+ * parent remembered from the descent, moving right if the parent has split
+ * in the meantime.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) -> bool {
+  std::vector<page_id_t> path;
+  page_id_t leaf_id = DescendBLink(key, &path);
+  if (leaf_id == INVALID_PAGE_ID) {
+    // 树是空的，加header写锁创建根节点
+    WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+    auto root_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+    if (root_page->root_page_id_ == INVALID_PAGE_ID) {
+      NewTreePage(&root_page->root_page_id_);
+      WritePageGuard leaf_guard = bpm_->FetchPageWrite(root_page->root_page_id_);
+      auto leaf_page = leaf_guard.template AsMut<LeafPage>();
+      leaf_page->Init(leaf_max_size_);
+      leaf_page->Add(key, value, comparator_);
+      return true;
+    }
+    // 其他线程已经创建了根节点
+    header_guard.Drop();
+    leaf_id = DescendBLink(key, &path);
+  }
+  WritePageGuard guard = bpm_->FetchPageWrite(leaf_id);
+  MoveRight(&guard, key);
+  auto leaf_page = guard.template AsMut<LeafPage>();
+  ValueType find_value;
+  if (leaf_page->LeafFind(key, comparator_, &find_value)) {
+    // 该key已经存在
+    return false;
+  }
+  leaf_page->Add(key, value, comparator_);
+  if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
+    return true;
+  }
+  // 叶节点满了，分裂出右边的新节点
+  page_id_t new_page_id;
+  BasicPageGuard new_guard = NewTreePage(&new_page_id);
+  auto new_leaf_page = new_guard.template AsMut<LeafPage>();
+  new_leaf_page->Init(leaf_max_size_);
+  LeafPage::Redistribute(leaf_page, new_leaf_page);
+  new_leaf_page->SetNextPageId(leaf_page->GetNextPageId());
+  leaf_page->SetNextPageId(new_page_id);
+  KeyType separator = new_leaf_page->KeyAt(0);
+  page_id_t page_id = guard.PageId();
+  // 新节点已经可以通过right link访问，释放后再去修改parent
+  new_guard.Drop();
+  guard.Drop();
+  InsertIntoParentBLink(page_id, 0, separator, new_page_id, std::move(path));
+  return true;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::UpdateInternalNode(WritePageGuard child_guard, Context &ctx) {
-  auto child_page = child_guard.template AsMut<InternalPage>();
-  if (ctx.write_set_.empty()) {
+void BPLUSTREE_TYPE::InsertIntoParentBLink(page_id_t page_id, int height, KeyType separator, page_id_t new_page_id,
+                                           std::vector<page_id_t> path) {
+  while (true) {
+    // path从根节点开始，高度为height的page的parent在path[path.size() - 1 - height]
+    int depth = static_cast<int>(path.size()) - 1 - height;
+    if (depth < 0) {
+      // 分裂的page在下降时是根节点。先释放了page再加header写锁，和从header往下加锁的读者不会死锁
+      WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+      auto root_page = header_guard.AsMut<BPlusTreeHeaderPage>();
+      if (root_page->root_page_id_ == page_id) {
+        page_id_t new_root_id;
+        BasicPageGuard new_root_guard = NewTreePage(&new_root_id);
+        auto new_root_page = new_root_guard.template AsMut<InternalPage>();
+        new_root_page->Init(internal_max_size_);
+        // 索引0的key不会被使用
+        new_root_page->Add(separator, page_id, comparator_);
+        new_root_page->Add(separator, new_page_id, comparator_);
+        root_page->root_page_id_ = new_root_id;
+        return;
+      }
+      // 根节点已经被其他线程分裂，重新下降找到parent
+      header_guard.Drop();
+      DescendBLink(separator, &path);
+      continue;
+    }
+    WritePageGuard guard = bpm_->FetchPageWrite(path[depth]);
+    MoveRight(&guard, separator);
+    auto page = guard.template AsMut<InternalPage>();
+    if (page->GetSize() < page->GetMaxSize()) {
+      page->Add(separator, new_page_id, comparator_);
+      return;
+    }
+    // parent也满了，继续分裂
+    page_id_t new_internal_page_id;
+    BasicPageGuard new_internal_guard = NewTreePage(&new_internal_page_id);
+    auto new_internal_page = new_internal_guard.template AsMut<InternalPage>();
+    new_internal_page->Init(internal_max_size_);
+    InternalPage::RedistributeWithInsert(page, new_internal_page, separator, new_page_id, comparator_);
+    new_internal_page->SetNextPageId(page->GetNextPageId());
+    page->SetNextPageId(new_internal_page_id);
+    separator = new_internal_page->KeyAt(0);
+    page_id = guard.PageId();
+    new_page_id = new_internal_page_id;
+    height++;
+  }
+}
+
+/*
+ * B-link removal only latches the leaf. Pages are not merged, so the
+ * structure above the leaves never changes on removal.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key) {
+  page_id_t leaf_id = DescendBLink(key, nullptr);
+  if (leaf_id == INVALID_PAGE_ID) {
+    // 树是空的
     return;
   }
-  auto parent_guard = std::move(ctx.write_set_.back());
-  ctx.write_set_.pop_back();
-  auto parent_page = parent_guard.template AsMut<InternalPage>();
-  int index = parent_page->ValueIndex(child_guard.PageId());
-  while (comparator_(parent_page->KeyAt(index), child_page->KeyAt(0)) != 0 &&
-         parent_guard.PageId() != ctx.root_page_id_) {
-    // 递归更新internal page的key
-    parent_page->SetKeyAt(index, child_page->KeyAt(0));
-    child_page = parent_page;
-    child_guard = std::move(parent_guard);
-    parent_guard = std::move(ctx.write_set_.back());
-    ctx.write_set_.pop_back();
-    parent_page = parent_guard.template AsMut<InternalPage>();
-    index = parent_page->ValueIndex(child_guard.PageId());
+  WritePageGuard guard = bpm_->FetchPageWrite(leaf_id);
+  MoveRight(&guard, key);
+  ValueType find_value;
+  if (guard.template As<LeafPage>()->LeafFind(key, comparator_, &find_value)) {
+    guard.template AsMut<LeafPage>()->Remove(key, comparator_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::DescendBLink(const KeyType &key, std::vector<page_id_t> *path) -> page_id_t {
+  if (path != nullptr) {
+    path->clear();
+  }
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  guard = bpm_->FetchPageRead(page_id);
+  MoveRight(&guard, key);
+  while (!guard.template As<BPlusTreePage>()->IsLeafPage()) {
+    if (path != nullptr) {
+      path->push_back(guard.PageId());
+    }
+    page_id = guard.template As<InternalPage>()->InternalFind(key, comparator_);
+    guard = bpm_->FetchPageRead(page_id);
+    MoveRight(&guard, key);
+  }
+  return guard.PageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RightPageFor(const BPlusTreePage *page, const KeyType &key) const -> page_id_t {
+  if (page->IsLeafPage()) {
+    auto leaf_page = reinterpret_cast<const LeafPage *>(page);
+    return leaf_page->IsBeyondHighKey(key, comparator_) ? leaf_page->GetNextPageId() : INVALID_PAGE_ID;
+  }
+  auto internal_page = reinterpret_cast<const InternalPage *>(page);
+  return internal_page->IsBeyondHighKey(key, comparator_) ? internal_page->GetNextPageId() : INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MoveRight(ReadPageGuard *guard, const KeyType &key) {
+  // 先锁右边的page再释放当前page，同一层总是从左往右加锁
+  for (page_id_t page_id = RightPageFor(guard->template As<BPlusTreePage>(), key); page_id != INVALID_PAGE_ID;
+       page_id = RightPageFor(guard->template As<BPlusTreePage>(), key)) {
+    *guard = bpm_->FetchPageRead(page_id, AccessType::Get);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::MoveRight(WritePageGuard *guard, const KeyType &key) {
+  for (page_id_t page_id = RightPageFor(guard->template As<BPlusTreePage>(), key); page_id != INVALID_PAGE_ID;
+       page_id = RightPageFor(guard->template As<BPlusTreePage>(), key)) {
+    *guard = bpm_->FetchPageWrite(page_id);
   }
 }
 /*****************************************************************************
@@ -428,22 +912,23 @@ void BPLUSTREE_TYPE::UpdateInternalNode(WritePageGuard child_guard, Context &ctx
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_, AccessType::Get);
   auto root_page = guard.template As<BPlusTreeHeaderPage>();
   if (root_page->root_page_id_ == INVALID_PAGE_ID) {
     // 树是空的
     return INDEXITERATOR_TYPE(std::move(guard), -1, bpm_);
   }
-  guard = bpm_->FetchPageRead(root_page->root_page_id_);
+  guard = bpm_->FetchPageRead(root_page->root_page_id_, AccessType::Get);
   auto page = guard.template As<BPlusTreePage>();
   while (!page->IsLeafPage()) {
     // 顺着内部节点查询
     auto internal_page = guard.template As<InternalPage>();
     page_id_t page_id = internal_page->ValueAt(0);
-    guard = bpm_->FetchPageRead(page_id);
+    guard = bpm_->FetchPageRead(page_id, AccessType::Get);
     page = guard.template As<BPlusTreePage>();
   }
-  // 查找到叶节点
+  // 查找到叶节点，预读下一个叶节点
+  bpm_->PrefetchPage(guard.template As<LeafPage>()->GetNextPageId());
   return INDEXITERATOR_TYPE(std::move(guard), 0, bpm_);
 }
 
@@ -454,23 +939,25 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
+  ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_, AccessType::Get);
   auto root_page = guard.template As<BPlusTreeHeaderPage>();
   if (root_page->root_page_id_ == INVALID_PAGE_ID) {
     // 树是空的
     return INDEXITERATOR_TYPE(std::move(guard), -1, bpm_);
   }
-  guard = bpm_->FetchPageRead(root_page->root_page_id_);
+  guard = bpm_->FetchPageRead(root_page->root_page_id_, AccessType::Get);
+  MoveRight(&guard, key);
   auto page = guard.template As<BPlusTreePage>();
   while (!page->IsLeafPage()) {
     // 顺着内部节点查询
     auto internal_page = guard.template As<InternalPage>();
     page_id_t page_id = internal_page->InternalFind(key, comparator_);
-    guard = bpm_->FetchPageRead(page_id);
+    guard = bpm_->FetchPageRead(page_id, AccessType::Get);
+    MoveRight(&guard, key);
     page = guard.template As<BPlusTreePage>();
   }
-  // 查找到叶节点
-  //  auto leaf_page = guard.template As<LeafPage>();
+  // 查找到叶节点，预读下一个叶节点
+  bpm_->PrefetchPage(guard.template As<LeafPage>()->GetNextPageId());
   return INDEXITERATOR_TYPE(std::move(guard), 0, bpm_);
 }
 
@@ -496,6 +983,10 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
     guard = bpm_->FetchPageRead(page_id);
     page = guard.template As<BPlusTreePage>();
   }
+  // 刚分裂出的叶节点可能还没有插入parent，沿next page id找到最后一个叶节点
+  while (guard.template As<LeafPage>()->GetNextPageId() != INVALID_PAGE_ID) {
+    guard = bpm_->FetchPageRead(guard.template As<LeafPage>()->GetNextPageId());
+  }
   // 查找到叶节点
   return INDEXITERATOR_TYPE(std::move(guard), -1, bpm_);
 }
@@ -510,6 +1001,49 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
   return root_page->root_page_id_;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetBufferGroup(buffer_group_t group) {
+  // 持有header page的写latch，遍历期间树的结构不会变
+  WritePageGuard header_guard = bpm_->FetchPageWrite(header_page_id_);
+  buffer_group_ = group;
+  bpm_->SetPageGroup(header_page_id_, group);
+  auto root_page_id = header_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (root_page_id != INVALID_PAGE_ID) {
+    SetSubtreeGroup(root_page_id, group);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetSubtreeGroup(page_id_t page_id, buffer_group_t group) {
+  bpm_->SetPageGroup(page_id, group);
+  ReadPageGuard guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+  auto page = guard.template As<BPlusTreePage>();
+  if (page->IsLeafPage()) {
+    return;
+  }
+  auto internal_page = guard.template As<InternalPage>();
+  for (int i = 0; i < internal_page->GetSize(); i++) {
+    SetSubtreeGroup(internal_page->ValueAt(i), group);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::NewTreePage(page_id_t *page_id) -> BasicPageGuard {
+  BasicPageGuard guard = bpm_->NewPageGuarded(page_id);
+  if (buffer_group_t group = buffer_group_; group != DEFAULT_BUFFER_GROUP && *page_id != INVALID_PAGE_ID) {
+    bpm_->SetPageGroup(*page_id, group);
+  }
+  return guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeleteTreePage(page_id_t page_id) {
+  // 乐观读或者迭代器还pin着这个page的时候删除会失败，等最后一个pin释放再删除，否则page id永远不会被回收
+  if (!bpm_->DeletePage(page_id)) {
+    bpm_->DeferDeletePage(page_id);
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
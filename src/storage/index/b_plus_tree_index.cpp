@@ -33,6 +33,22 @@ auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   return container_->Insert(index_key, rid, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+  // construct insert index keys, sorted so that the tree descends once per leaf
+  std::vector<std::pair<KeyType, ValueType>> index_entries;
+  index_entries.reserve(entries.size());
+  for (const auto &[key, rid] : entries) {
+    KeyType index_key;
+    index_key.SetFromKey(key);
+    index_entries.emplace_back(index_key, rid);
+  }
+  std::stable_sort(index_entries.begin(), index_entries.end(),
+                   [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+
+  container_->InsertBatch(index_entries, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
@@ -51,6 +67,14 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_->GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SetBufferGroup(buffer_group_t group) { container_->SetBufferGroup(group); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries) -> bool {
+  return container_->BulkLoad(std::move(entries));
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_->Begin(); }
 
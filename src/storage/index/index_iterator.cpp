@@ -33,14 +33,25 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   if (index_ < page->GetSize() - 1) {
     index_++;
   } else {
-    if (page->GetNextPageId() != INVALID_PAGE_ID) {
-      guard_ = bpm_->FetchPageRead(page->GetNextPageId());
+    NextLeaf();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextLeaf() {
+  auto page = guard_.template As<LeafPage>();
+  while (page->GetNextPageId() != INVALID_PAGE_ID) {
+    guard_ = bpm_->FetchPageRead(page->GetNextPageId(), AccessType::Scan);
+    page = guard_.template As<LeafPage>();
+    // 在读当前叶节点的同时预读下一个叶节点
+    bpm_->PrefetchPage(page->GetNextPageId());
+    if (page->GetSize() > 0) {
       index_ = 0;
-    } else {
-      index_ = -1;
+      return;
     }
   }
-  return *this;
+  index_ = -1;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
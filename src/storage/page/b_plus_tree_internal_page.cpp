@@ -28,6 +28,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetSize(0);
   SetMaxSize(max_size);
+  SetNextPageId(INVALID_PAGE_ID);
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -56,6 +57,27 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const ->
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
 
+/*
+ * Helper methods to set/get next page id and high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsBeyondHighKey(const KeyType &key, const KeyComparator &comparator) const
+    -> bool {
+  return next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InternalFind(const KeyType &key, const KeyComparator &comparator) const
     -> page_id_t {
@@ -84,7 +106,8 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Add(const KeyType key, const page_id_t page_id, const KeyComparator comparator) {
   int size = GetSize();
   int i = size - 1;
-  while (i >= 0 && comparator(key, array_[i].first) < 0) {
+  // 索引0的key只是下界，不参与比较
+  while (i >= 1 && comparator(key, array_[i].first) < 0) {
     array_[i + 1] = array_[i];
     i--;
   }
@@ -110,17 +133,27 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RedistributeWithInsert(BPlusTreeInternalPag
   page->SetSize(half_size);
   new_page->SetSize(page->GetMaxSize() - half_size);
   // 判断新的key插入哪
-  if (is_not_balance || comparator(key, new_page->array_[0].first) > 0) {
+  if (is_not_balance && comparator(key, new_page->array_[0].first) < 0) {
+    // 新的key成为new page的第一个key，Add不会插入到索引0
+    for (int i = new_page->GetSize(); i > 0; i--) {
+      new_page->array_[i] = new_page->array_[i - 1];
+    }
+    new_page->array_[0].first = key;
+    new_page->array_[0].second = page_id;
+    new_page->SetSize(new_page->GetSize() + 1);
+  } else if (is_not_balance || comparator(key, new_page->array_[0].first) > 0) {
     new_page->Add(key, page_id, comparator);
   } else {
     page->Add(key, page_id, comparator);
   }
+  new_page->SetHighKey(page->GetHighKey());
+  page->SetHighKey(new_page->KeyAt(0));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(KeyType key, KeyComparator comparator) {
   // 二分查找
-  int low = 0;
+  int low = 1;  // 索引0的key只是下界，不参与查找
   int high = GetSize() - 1;
 
   while (low <= high) {
@@ -150,6 +183,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InternalMerge(BPlusTreeInternalPage *page,
   }
   page->SetSize(page->GetSize() + sibling_page->GetSize());
   sibling_page->SetSize(0);
+  page->SetNextPageId(sibling_page->GetNextPageId());
+  page->SetHighKey(sibling_page->GetHighKey());
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -169,6 +204,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveOneKey(BPlusTreeInternalPage *page, BPl
     page->SetSize(page->GetSize() - 1);
     sibling_page->SetSize(sibling_page->GetSize() + 1);
   }
+  page->SetHighKey(sibling_page->KeyAt(0));
 }
 
 // valuetype for internalNode should be page id_t
@@ -30,6 +30,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetMaxSize(max_size);
+  SetNextPageId(INVALID_PAGE_ID);
 }
 
 /**
@@ -41,6 +42,17 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::IsBeyondHighKey(const KeyType &key, const KeyComparator &comparator) const -> bool {
+  return next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0;
+}
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -53,17 +65,23 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::PairAt(int index) const -> const MappingType &
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Add(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+  // 从后往前把比key大的元素后移一位，按顺序插入时不需要移动
+  int i = GetSize() - 1;
+  while (i >= 0 && comparator(key, array_[i].first) < 0) {
+    array_[i + 1] = array_[i];
+    i--;
+  }
+  array_[i + 1].first = key;
+  array_[i + 1].second = value;
+  SetSize(GetSize() + 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
   int size = GetSize();
   array_[size].first = key;
   array_[size].second = value;
-  size++;
-  SetSize(size);
-  // TODO(hmwei): 不需要每次排序
-  // 使用Lambda表达式指定比较方式，比较数组的 first 元素
-  std::sort(array_, array_ + size, [&comparator](const auto &a, const auto &b) {
-    // 从小到大排列
-    return comparator(a.first, b.first) < 0;
-  });
+  SetSize(size + 1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -96,6 +114,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Redistribute(BPlusTreeLeafPage *page, BPlusTree
   }
   page->SetSize(half_size);
   new_page->SetSize(page->GetMaxSize() - half_size);
+  new_page->SetHighKey(page->GetHighKey());
+  page->SetHighKey(new_page->KeyAt(0));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -130,6 +150,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveOneKey(BPlusTreeLeafPage *page, BPlusTreeLe
   }
   page->SetSize(page->GetSize() + 1);
   sibling_page->SetSize(sibling_page->GetSize() - 1);
+  page->SetHighKey(sibling_page->KeyAt(0));
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -142,6 +163,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::LeafMerge(BPlusTreeLeafPage *page, BPlusTreeLea
   page->SetSize(page->GetSize() + sibling_page->GetSize());
   sibling_page->SetSize(0);
   page->SetNextPageId(sibling_page->GetNextPageId());
+  page->SetHighKey(sibling_page->GetHighKey());
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
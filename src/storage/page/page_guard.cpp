@@ -17,7 +17,7 @@ BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept {
 
 void BasicPageGuard::Drop() {
   if (page_ != nullptr) {
-    bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+    bpm_->ReleasePage(page_, is_dirty_);
   }
   bpm_ = nullptr;
   page_ = nullptr;
@@ -59,6 +59,15 @@ void ReadPageGuard::Drop() {
 
 ReadPageGuard::~ReadPageGuard() { Drop(); }  // NOLINT
 
+auto ReadPageGuard::TryUpgrade() -> std::optional<WritePageGuard> {
+  if (guard_.page_ == nullptr || !guard_.page_->TryUpgradeRLatch()) {
+    return std::nullopt;
+  }
+  WritePageGuard write_guard;
+  write_guard.guard_ = std::move(guard_);
+  return write_guard;
+}
+
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept { this->guard_ = std::move(that.guard_); }
 
 auto WritePageGuard::operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
@@ -76,4 +85,32 @@ void WritePageGuard::Drop() {
 
 WritePageGuard::~WritePageGuard() { Drop(); }  // NOLINT
 
+UpgradablePageGuard::UpgradablePageGuard(UpgradablePageGuard &&that) noexcept {
+  this->guard_ = std::move(that.guard_);
+}
+
+auto UpgradablePageGuard::operator=(UpgradablePageGuard &&that) noexcept -> UpgradablePageGuard & {
+  Drop();
+  this->guard_ = std::move(that.guard_);
+  return *this;
+}
+
+void UpgradablePageGuard::Drop() {
+  if (this->guard_.page_ != nullptr) {
+    this->guard_.page_->UUnlatch();
+  }
+  guard_.Drop();
+}
+
+UpgradablePageGuard::~UpgradablePageGuard() { Drop(); }  // NOLINT
+
+auto UpgradablePageGuard::Upgrade() -> WritePageGuard {
+  WritePageGuard write_guard;
+  if (guard_.page_ != nullptr) {
+    guard_.page_->UpgradeLatch();
+    write_guard.guard_ = std::move(guard_);
+  }
+  return write_guard;
+}
+
 }  // namespace bustub
@@ -52,6 +52,9 @@ auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManag
     page_id_t next_page_id = INVALID_PAGE_ID;
     auto npg = bpm_->NewPage(&next_page_id);
     BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
+    if (buffer_group_ != DEFAULT_BUFFER_GROUP) {
+      bpm_->SetPageGroup(next_page_id, buffer_group_);
+    }
 
     page->SetNextPageId(next_page_id);
 
@@ -91,8 +94,8 @@ void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
   page->UpdateTupleMeta(meta, rid);
 }
 
-auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
-  auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
+auto TableHeap::GetTuple(RID rid, AccessType access_type) -> std::pair<TupleMeta, Tuple> {
+  auto page_guard = bpm_->FetchPageRead(rid.GetPageId(), access_type);
   auto page = page_guard.As<TablePage>();
   auto [meta, tuple] = page->GetTuple(rid);
   tuple.rid_ = rid;
@@ -105,12 +108,23 @@ auto TableHeap::GetTupleMeta(RID rid) -> TupleMeta {
   return page->GetTupleMeta(rid);
 }
 
+void TableHeap::SetBufferGroup(buffer_group_t group) {
+  // 持有latch_，遍历期间不会有新的page
+  std::lock_guard<std::mutex> guard(latch_);
+  buffer_group_ = group;
+  for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    bpm_->SetPageGroup(page_id, group);
+    auto page_guard = bpm_->FetchPageRead(page_id, AccessType::Scan);
+    page_id = page_guard.As<TablePage>()->GetNextPageId();
+  }
+}
+
 auto TableHeap::MakeIterator() -> TableIterator {
   std::unique_lock<std::mutex> guard(latch_);
   auto last_page_id = last_page_id_;
   guard.unlock();
 
-  auto page_guard = bpm_->FetchPageRead(last_page_id);
+  auto page_guard = bpm_->FetchPageRead(last_page_id, AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   return {this, {first_page_id_, 0}, {last_page_id, page->GetNumTuples()}};
 }
@@ -24,23 +24,31 @@ TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
     : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
   // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
   // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   if (rid_.GetSlotNum() >= page->GetNumTuples()) {
     rid_ = RID{INVALID_PAGE_ID, 0};
+    return;
   }
+  ReadAhead(rid_.GetPageId(), page->GetNextPageId());
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> {
+  return table_heap_->GetTuple(rid_, AccessType::Scan);
+}
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId(), AccessType::Scan);
   auto page = page_guard.As<TablePage>();
   auto next_tuple_id = rid_.GetSlotNum() + 1;
+  if (rid_.GetSlotNum() == 0) {
+    // 刚进入这个page，继续往后预读
+    ReadAhead(rid_.GetPageId(), page->GetNextPageId());
+  }
 
   if (stop_at_rid_.GetPageId() != INVALID_PAGE_ID) {
     BUSTUB_ASSERT(
@@ -60,6 +68,9 @@ auto TableIterator::operator++() -> TableIterator & {
     auto next_page_id = page->GetNextPageId();
     // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
     rid_ = RID{next_page_id, 0};
+    if (read_ahead_distance_ > 0) {
+      read_ahead_distance_--;
+    }
   }
 
   page_guard.Drop();
@@ -67,4 +78,28 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t page_id, page_id_t next_page_id) {
+  if (read_ahead_distance_ == 0) {
+    read_ahead_page_id_ = page_id;
+  }
+  auto *bpm = table_heap_->bpm_;
+  while (read_ahead_distance_ < table_scan_read_ahead && read_ahead_page_id_ != stop_at_rid_.GetPageId()) {
+    page_id_t frontier_next_page_id = next_page_id;
+    if (read_ahead_page_id_ != page_id) {
+      // 只沿着已经读进buffer pool的page往后走，不等待disk
+      if (!bpm->IsPageCached(read_ahead_page_id_)) {
+        break;
+      }
+      auto frontier_guard = bpm->FetchPageRead(read_ahead_page_id_, AccessType::Scan);
+      frontier_next_page_id = frontier_guard.As<TablePage>()->GetNextPageId();
+    }
+    if (frontier_next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    bpm->PrefetchPage(frontier_next_page_id);
+    read_ahead_page_id_ = frontier_next_page_id;
+    read_ahead_distance_++;
+  }
+}
+
 }  // namespace bustub
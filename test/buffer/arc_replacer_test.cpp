@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ArcReplacerTest, SampleTest) {
+  ArcReplacer replacer(4);
+  int value;
+
+  // Scenario: frames 0..3 hold pages 100..103. Frame 0 is accessed twice and moves to T2, the others stay in T1.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Unknown, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.RecordAccess(0, AccessType::Unknown, 100);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+
+  // T1 is larger than its target, so its least recently used frame goes first and page 101 is remembered in B1.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 101 comes back while it is in B1. T1 was too small, so its target grows, and the page joins T2.
+  replacer.RecordAccess(1, AccessType::Unknown, 101);
+  replacer.SetEvictable(1, true);
+  ASSERT_EQ(1, replacer.GetTargetRecentSize());
+
+  // T1 holds frames 2 and 3: frame 2 is evicted to bring T1 down to its target, then T2 loses frame 0.
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Scenario: page 100 comes back while it is in B2. T2 was too small, so the target of T1 shrinks.
+  replacer.RecordAccess(0, AccessType::Unknown, 100);
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+
+  // Scenario: a scan reads page 104 twice. It is not promoted to T2 and is not remembered once evicted.
+  replacer.RecordAccess(2, AccessType::Scan, 104);
+  replacer.RecordAccess(2, AccessType::Scan, 104);
+  replacer.SetEvictable(2, true);
+  for (frame_id_t expected : {3, 2, 1, 0}) {
+    ASSERT_TRUE(replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_FALSE(replacer.Evict(&value));
+
+  // A scanned page is a plain miss, while page 103, evicted from T1, grows the target of T1 again.
+  replacer.RecordAccess(3, AccessType::Unknown, 104);
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+  replacer.RecordAccess(2, AccessType::Unknown, 103);
+  ASSERT_EQ(1, replacer.GetTargetRecentSize());
+
+  // Only evictable frames can be removed.
+  ASSERT_THROW(replacer.Remove(3), Exception);
+  replacer.SetEvictable(3, true);
+  replacer.Remove(3);
+  ASSERT_EQ(0, replacer.Size());
+  ASSERT_THROW(replacer.RecordAccess(4), Exception);
+}
+
+TEST(ArcReplacerTest, EvictFrameTest) {
+  ArcReplacer replacer(4);
+  int value;
+
+  // Scenario: frames 0..2 hold pages 100..102 in T1, frame 1 is picked by the caller instead of the LRU frame 0.
+  for (frame_id_t frame_id = 0; frame_id < 3; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Unknown, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.EvictFrame(1);
+  ASSERT_EQ(2, replacer.Size());
+
+  // Page 101 is remembered in B1 like a regular victim, so its return grows the target of T1.
+  replacer.RecordAccess(1, AccessType::Unknown, 101);
+  replacer.SetEvictable(1, true);
+  ASSERT_EQ(1, replacer.GetTargetRecentSize());
+
+  // Scenario: frame 1 is now in T2 and is picked again. Page 101 is remembered in B2 and shrinks the target.
+  replacer.EvictFrame(1);
+  replacer.RecordAccess(1, AccessType::Unknown, 101);
+  replacer.SetEvictable(1, true);
+  ASSERT_EQ(0, replacer.GetTargetRecentSize());
+
+  // Untracked frames are ignored and pinned frames cannot be picked.
+  replacer.EvictFrame(3);
+  replacer.SetEvictable(0, false);
+  ASSERT_THROW(replacer.EvictFrame(0), Exception);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+}
+
+}  // namespace bustub
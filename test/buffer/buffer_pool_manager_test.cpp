@@ -12,11 +12,18 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -145,4 +152,790 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PartitionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_partitions = 3;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, k, nullptr, num_partitions);
+  EXPECT_EQ(num_partitions, bpm->GetNumPartitions());
+
+  // Scenario: Every frame of every partition can hold a new page, and page ids are never handed out twice.
+  std::set<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id_temp, page->GetPageId());
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.insert(page_id_temp);
+  }
+  EXPECT_EQ(buffer_pool_size, page_ids.size());
+
+  // Scenario: Once all partitions are full, we should not be able to create any new pages.
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpin everything and cycle a new set of pages through the pool, evicting the old ones.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(0, page_ids.count(page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: Pages routed to any partition can be read back after being evicted.
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentEvictionTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  const size_t num_threads = 8;
+  const size_t num_rounds = 200;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), 0, BUSTUB_PAGE_SIZE);
+    page_ids.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  disk_manager->SetLatency(1);
+
+  // Scenario: Threads keep dirtying pages that are constantly evicted and re-read while the disk is slow. Every
+  // increment must survive the write-back / read-back cycle, i.e. no thread may read a page that is still being
+  // written back.
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < num_threads; ++thread_id) {
+    threads.emplace_back([&bpm, &page_ids, thread_id] {
+      for (size_t round = 0; round < num_rounds; ++round) {
+        page_id_t page_id = page_ids[(thread_id + round * 7) % num_pages];
+        Page *page = nullptr;
+        while (page == nullptr) {
+          page = bpm->FetchPage(page_id);
+        }
+        page->WLatch();
+        ++*reinterpret_cast<uint32_t *>(page->GetData());
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->SetLatency(0);
+  uint32_t total = 0;
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    total += *reinterpret_cast<uint32_t *>(page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_threads * num_rounds, total);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 5;
+  const size_t num_pages = 20;
+  const size_t k = 2;
+
+  for (auto policy : {ReplacerPolicy::LRUK, ReplacerPolicy::LRU, ReplacerPolicy::Clock, ReplacerPolicy::TwoQueue,
+                      ReplacerPolicy::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, 1, policy);
+    EXPECT_EQ(policy, bpm->GetReplacerPolicy());
+    EXPECT_EQ(policy, ReplacerPolicyFromString(ReplacerPolicyToString(policy)));
+
+    // Scenario: cycle more pages than frames through the pool, keeping one of them pinned all along.
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+      page_ids.push_back(page_id_temp);
+      if (i != 0) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+      }
+    }
+
+    // Scenario: switching the policy keeps the resident pages and the pin of page 0.
+    bpm->SetReplacerPolicy(ReplacerPolicy::Clock);
+    EXPECT_EQ(ReplacerPolicy::Clock, bpm->GetReplacerPolicy());
+    for (size_t round = 0; round < 2; ++round) {
+      for (auto page_id : page_ids) {
+        auto *page = bpm->FetchPage(page_id, round == 0 ? AccessType::Scan : AccessType::Get);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+    EXPECT_EQ(false, bpm->UnpinPage(page_ids[0], false));
+  }
+  EXPECT_EQ(std::nullopt, ReplacerPolicyFromString("mru"));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto saved_interval = bpm_flusher_interval;
+  auto saved_low_watermark = bpm_flusher_low_watermark;
+  auto saved_high_watermark = bpm_flusher_high_watermark;
+  bpm_flusher_interval = std::chrono::milliseconds(1);
+  bpm_flusher_low_watermark = 0.5;
+  bpm_flusher_high_watermark = 0.8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto log_manager = std::make_unique<LogManager>(disk_manager.get());
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, log_manager.get());
+  auto dirty_pages = [&bpm] {
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetFrame(i)->IsDirty()) {
+        page_ids.push_back(bpm->GetFrame(i)->GetPageId());
+      }
+    }
+    return page_ids;
+  };
+  auto wait_for_dirty_pages = [&dirty_pages](size_t count) {
+    for (int i = 0; i < 1000 && dirty_pages().size() > count; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return dirty_pages();
+  };
+
+  // Scenario: the pool is full of dirty pages, so the flusher cleans them in eviction order until 80% are clean.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData() + 64, BUSTUB_PAGE_SIZE - 64, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->StartBackgroundFlusher();
+  EXPECT_EQ((std::vector<page_id_t>{8, 9}), wait_for_dirty_pages(2));
+  bpm->StopBackgroundFlusher();
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(0, strcmp(data + 64, ("page " + std::to_string(page_id)).c_str()));
+  }
+
+  // Scenario: with logging enabled, pages are not written back before the log up to their LSN is persistent.
+  enable_logging = true;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->StartBackgroundFlusher();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(buffer_pool_size, dirty_pages().size());
+  log_manager->SetPersistentLSN(4);
+  EXPECT_EQ((std::vector<page_id_t>{5, 6, 7, 8, 9}), wait_for_dirty_pages(5));
+  bpm->StopBackgroundFlusher();
+  enable_logging = false;
+
+  bpm_flusher_interval = saved_interval;
+  bpm_flusher_low_watermark = saved_low_watermark;
+  bpm_flusher_high_watermark = saved_high_watermark;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 20;
+  const size_t k = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k);
+  auto wait_until_cached = [&bpm](page_id_t page_id) {
+    for (int i = 0; i < 1000 && !bpm->IsPageCached(page_id); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return bpm->IsPageCached(page_id);
+  };
+
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: while every resident page is dirty, a prefetch has no frame to read into.
+  EXPECT_EQ(false, bpm->PrefetchPage(0));
+  EXPECT_EQ(false, bpm->IsPageCached(0));
+
+  // Scenario: once the pool is clean, prefetched pages replace clean pages and are read in the background.
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->PrefetchPage(0));
+  EXPECT_EQ(false, bpm->PrefetchPage(0));
+  EXPECT_EQ(false, bpm->PrefetchPage(INVALID_PAGE_ID));
+  EXPECT_EQ(3, bpm->PrefetchPages({1, 2, 3}));
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    EXPECT_EQ(true, wait_until_cached(page_id));
+  }
+
+  // Scenario: a fetch racing with a slow prefetch waits for the read instead of reading stale data.
+  disk_manager->SetLatency(20);
+  EXPECT_EQ(true, bpm->PrefetchPage(4));
+  EXPECT_EQ(true, bpm->PrefetchPage(5));
+  for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  // Deleting a page that is being prefetched waits for the read to complete.
+  EXPECT_EQ(true, bpm->DeletePage(5));
+  disk_manager->SetLatency(0);
+
+  // Scenario: prefetched pages are not pinned, so every frame can still be reused.
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    pages.push_back(page);
+  }
+  for (auto *page : pages) {
+    EXPECT_EQ(true, bpm->UnpinPage(page->GetPageId(), false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_partitions = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_partitions);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  // Scenario: only dirty pages are written, and pages from different partitions are written together.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, page_id % 3 != 0));
+  }
+  int writes = disk_manager->GetNumWrites();
+  int syncs = disk_manager->GetNumSyncs();
+  bpm->FlushAllPages();
+  int dirty = std::count_if(page_ids.begin(), page_ids.end(), [](page_id_t page_id) { return page_id % 3 != 0; });
+  EXPECT_EQ(writes + dirty, disk_manager->GetNumWrites());
+  EXPECT_EQ(syncs + 1, disk_manager->GetNumSyncs());
+
+  // Scenario: flushed pages are clean, so flushing again writes nothing.
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + dirty, disk_manager->GetNumWrites());
+
+  // Scenario: the pages read back from disk match what was written.
+  auto *reader = new DiskManager(db_name);
+  char buf[BUSTUB_PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    if (page_id % 3 == 0) {
+      continue;
+    }
+    reader->ReadPage(page_id, buf);
+    EXPECT_EQ(0, strcmp(buf, ("page " + std::to_string(page_id)).c_str()));
+  }
+  reader->ShutDown();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete reader;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReuseTest) {
+  const size_t buffer_pool_size = 10;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    page_ids.push_back(page_id_temp);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+
+  // Scenario: a pinned page cannot be deleted, so its id is not freed.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[1]));
+  EXPECT_EQ(false, bpm->DeletePage(page_ids[1]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], false));
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: deleted pages are reused, lowest first.
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[5]));
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[1]));
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[3]));
+  EXPECT_EQ(3, disk_manager->GetNumFreePages());
+  for (size_t i : {1, 3, 5}) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_ids[i], page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  // Scenario: a page that is not in the buffer pool is freed on disk, a page that was never allocated is ignored.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(false, bpm->IsPageCached(page_ids[0]));
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[0]));
+  EXPECT_EQ(true, bpm->DeletePage(1000));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  EXPECT_EQ(true, disk_manager->IsPageFree(page_ids[0]));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DeferDeletePageTest) {
+  const size_t buffer_pool_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_ids[2];
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  // Scenario: an unpinned page is deleted right away.
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[0], false));
+  bpm->DeferDeletePage(page_ids[0]);
+  EXPECT_EQ(false, bpm->IsPageCached(page_ids[0]));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+
+  // Scenario: a pinned page stays in the buffer pool until its last pin is released.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[1]));
+  EXPECT_EQ(false, bpm->DeletePage(page_ids[1]));
+  bpm->DeferDeletePage(page_ids[1]);
+  EXPECT_EQ(true, bpm->IsPageCached(page_ids[1]));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], false));
+  EXPECT_EQ(true, bpm->IsPageCached(page_ids[1]));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[1], true));
+  EXPECT_EQ(false, bpm->IsPageCached(page_ids[1]));
+  EXPECT_EQ(2, disk_manager->GetNumFreePages());
+  EXPECT_EQ(true, disk_manager->IsPageFree(page_ids[1]));
+
+  // Both page ids and frames are reused.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    if (i < 2) {
+      EXPECT_EQ(page_ids[i], page_id_temp);
+    }
+  }
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageReopenTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 20;
+  const size_t num_partitions = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_partitions);
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  std::set<page_id_t> deleted_page_ids{3, 8, 11};
+  for (auto page_id : deleted_page_ids) {
+    EXPECT_EQ(true, bpm->DeletePage(page_id));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: after reopening the db file, only the deleted pages are reused, then new ids come after the last page.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_partitions);
+  EXPECT_EQ(deleted_page_ids.size(), disk_manager->GetNumFreePages());
+  std::set<page_id_t> new_page_ids;
+  for (size_t i = 0; i < deleted_page_ids.size() + num_partitions; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    new_page_ids.insert(page_id_temp);
+  }
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+  for (auto page_id : new_page_ids) {
+    EXPECT_TRUE(deleted_page_ids.count(page_id) != 0 || page_id >= static_cast<page_id_t>(num_pages));
+  }
+  for (auto page_id : deleted_page_ids) {
+    EXPECT_EQ(1, new_page_ids.count(page_id));
+  }
+
+  // Scenario: the pages that were not deleted keep their data.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    if (deleted_page_ids.count(page_id) == 0) {
+      auto guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ("page " + std::to_string(page_id), guard.GetData());
+    }
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 8;
+  const size_t num_threads = 4;
+  const size_t rounds = 50;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: creating more pages than frames evicts dirty pages and writes them back.
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.new_pages_);
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.evictions_);
+  EXPECT_EQ(num_pages - buffer_pool_size, stats.dirty_writebacks_);
+  EXPECT_EQ(num_pages - buffer_pool_size, disk_manager->GetStats().writes_);
+
+  // Scenario: hits and misses add up over all threads.
+  bpm->ResetStats();
+  disk_manager->ResetStats();
+  EXPECT_EQ(0, bpm->GetStats().new_pages_);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&bpm, t] {
+      for (size_t i = 0; i < rounds; ++i) {
+        auto page_id = static_cast<page_id_t>((i + t) % num_pages);
+        Page *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_threads * rounds, stats.hits_ + stats.misses_ + stats.no_free_frame_);
+  EXPECT_GT(stats.misses_, 0);
+  EXPECT_EQ(stats.misses_, stats.miss_latency_.Count());
+  EXPECT_EQ(stats.misses_, disk_manager->GetStats().reads_);
+  EXPECT_EQ(stats.misses_, disk_manager->GetStats().read_latency_.Count());
+
+  // Scenario: percentiles are bucket upper bounds.
+  LatencyHistogram histogram;
+  histogram.buckets_[LatencyHistogram::BucketOf(3)] = 99;
+  histogram.buckets_[LatencyHistogram::BucketOf(1000)] = 1;
+  EXPECT_EQ(4, histogram.Percentile(0.5));
+  EXPECT_EQ(1024, histogram.Percentile(1));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LockFreePinTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  const size_t num_threads = 8;
+  const size_t rounds = 5000;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: hot pages are hit and unpinned without the latch while cold pages keep evicting frames. Every fetch
+  // must see the data of the page it asked for.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&bpm, t] {
+      std::mt19937 gen(t);
+      for (size_t i = 0; i < rounds; ++i) {
+        auto page_id = static_cast<page_id_t>(gen() % 4 == 0 ? gen() % num_pages : gen() % 4);
+        if (i % 2 == 0) {
+          auto guard = bpm->FetchPageRead(page_id);
+          EXPECT_EQ(std::to_string(page_id), guard.GetData());
+        } else {
+          auto guard = bpm->FetchPageWrite(page_id);
+          EXPECT_EQ(std::to_string(page_id), guard.GetDataMut());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every pin has been released: all frames can be reused.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    if (bpm->IsPageCached(page_id)) {
+      auto *page = bpm->FetchPage(page_id);
+      EXPECT_EQ(1, page->GetPinCount());
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  std::vector<page_id_t> new_pages;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    new_pages.push_back(page_id_temp);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : new_pages) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t grown_pool_size = 200;
+  const size_t num_partitions = 2;
+  const size_t k = 2;
+
+  auto saved_timeout = bpm_resize_timeout;
+  bpm_resize_timeout = std::chrono::milliseconds(50);
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), k, nullptr, num_partitions);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: growing the pool adds frames across several chunks while the resident pages stay pinned in place.
+  EXPECT_EQ(true, bpm->Resize(grown_pool_size));
+  EXPECT_EQ(grown_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < grown_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  std::vector<page_id_t> resident;
+  for (size_t i = 0; i < grown_pool_size; ++i) {
+    resident.push_back(bpm->GetFrame(i)->GetPageId());
+    EXPECT_EQ(std::to_string(resident.back()), bpm->GetFrame(i)->GetData());
+  }
+  EXPECT_EQ(std::set<page_id_t>(page_ids.begin(), page_ids.end()),
+            std::set<page_id_t>(resident.begin(), resident.end()));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: shrinking fails while a page of a frame that goes away is pinned, and the pool keeps working.
+  auto *pinned = bpm->FetchPage(page_ids.back());
+  ASSERT_NE(nullptr, pinned);
+  EXPECT_EQ(false, bpm->Resize(buffer_pool_size / 2));
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids.back(), false));
+
+  // Scenario: shrinking writes back the dirty pages that are evicted, so every page can still be read.
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size / 2));
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(std::to_string(page_id), guard.GetData());
+  }
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size / 2; ++i) {
+    guards.push_back(bpm->FetchPageBasic(page_ids[i]));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  guards.clear();
+
+  bpm_resize_timeout = saved_timeout;
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  const std::string db_name = "test.db";
+  const std::string warmup_name = "test.warmup";
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 30;
+  const size_t num_partitions = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_partitions);
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  // The last pages fetched are the hot set.
+  for (page_id_t page_id = num_pages - buffer_pool_size; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    auto guard = bpm->FetchPageRead(page_id);
+  }
+  bpm->SetWarmUpFile(warmup_name);
+  delete bpm;
+
+  // Scenario: a new buffer pool preloads the hot set with merged reads, and fetching it does not touch the disk.
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, num_partitions);
+  disk_manager->ResetStats();
+  EXPECT_EQ(buffer_pool_size, bpm->WarmUp(warmup_name));
+  for (page_id_t page_id = num_pages - buffer_pool_size; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    for (int i = 0; i < 1000 && !bpm->IsPageCached(page_id); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(bpm->IsPageCached(page_id));
+  }
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetStats().reads_);
+  for (page_id_t page_id = num_pages - buffer_pool_size; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ("page " + std::to_string(page_id), guard.GetData());
+  }
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetStats().reads_);
+
+  // Scenario: the ids of preloaded pages are not handed out again, and a missing file loads nothing.
+  page_id_t page_id_temp;
+  bpm->UnpinPage(num_pages - 1, false);
+  auto guard = bpm->NewPageGuarded(&page_id_temp);
+  EXPECT_GE(page_id_temp, static_cast<page_id_t>(num_pages));
+  guard.Drop();
+  EXPECT_EQ(0, bpm->WarmUp("missing.warmup"));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove(warmup_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, QuotaTest) {
+  const size_t buffer_pool_size = 10;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  for (auto priority : {BufferPriority::Low, BufferPriority::Normal, BufferPriority::High}) {
+    EXPECT_EQ(priority, BufferPriorityFromString(BufferPriorityToString(priority)));
+  }
+  EXPECT_EQ(std::nullopt, BufferPriorityFromString("urgent"));
+
+  auto new_pages = [&](size_t count, buffer_group_t group) {
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < count; ++i) {
+      page_id_t page_id;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+      bpm->SetPageGroup(page_id, group);
+      page_ids.push_back(page_id);
+    }
+    return page_ids;
+  };
+
+  // Scenario: the reserved pages of a group stay resident while a scan of other pages cycles through the pool.
+  auto reserved = bpm->CreateBufferGroup();
+  EXPECT_EQ(0, bpm->GetBufferQuota(reserved).min_frames_);
+  bpm->SetBufferQuota(reserved, BufferQuota{4, BufferPriority::Normal});
+  EXPECT_EQ(4, bpm->GetBufferQuota(reserved).min_frames_);
+  auto reserved_pages = new_pages(4, reserved);
+  EXPECT_EQ(4, bpm->GetResidentFrames(reserved));
+  auto scanned_pages = new_pages(3 * buffer_pool_size, DEFAULT_BUFFER_GROUP);
+  for (auto page_id : scanned_pages) {
+    auto guard = bpm->FetchPageRead(page_id, AccessType::Scan);
+  }
+  EXPECT_EQ(4, bpm->GetResidentFrames(reserved));
+  EXPECT_EQ(0, bpm->GetResidentFrames(DEFAULT_BUFFER_GROUP));
+
+  // Scenario: Low pages are evicted before Normal pages, and Normal pages before High pages.
+  bpm->SetBufferQuota(reserved, BufferQuota{0, BufferPriority::Low});
+  auto high = bpm->CreateBufferGroup();
+  bpm->SetBufferQuota(high, BufferQuota{0, BufferPriority::High});
+  auto high_pages = new_pages(3, high);
+  EXPECT_EQ(3, bpm->GetResidentFrames(high));
+  EXPECT_EQ(1, bpm->GetResidentFrames(reserved));
+  new_pages(buffer_pool_size, DEFAULT_BUFFER_GROUP);
+  EXPECT_EQ(0, bpm->GetResidentFrames(reserved));
+  EXPECT_EQ(3, bpm->GetResidentFrames(high));
+  for (auto page_id : reserved_pages) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+  }
+  EXPECT_EQ(3, bpm->GetResidentFrames(high));
+
+  // Scenario: regrouping a resident page and deleting pages keep the counts of resident frames right.
+  bpm->SetPageGroup(high_pages[0], DEFAULT_BUFFER_GROUP);
+  EXPECT_EQ(2, bpm->GetResidentFrames(high));
+  for (auto page_id : high_pages) {
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+  }
+  EXPECT_EQ(0, bpm->GetResidentFrames(high));
+}
+
 }  // namespace bustub
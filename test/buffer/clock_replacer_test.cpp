@@ -15,47 +15,55 @@
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  clock_replacer.RecordAccess(1);
+  clock_replacer.SetEvictable(1, true);
+  clock_replacer.RecordAccess(2);
+  clock_replacer.SetEvictable(2, true);
+  clock_replacer.RecordAccess(3);
+  clock_replacer.SetEvictable(3, true);
+  clock_replacer.RecordAccess(4);
+  clock_replacer.SetEvictable(4, true);
+  clock_replacer.RecordAccess(5);
+  clock_replacer.SetEvictable(5, true);
+  clock_replacer.RecordAccess(6);
+  clock_replacer.SetEvictable(6, true);
+  clock_replacer.SetEvictable(1, true);
   EXPECT_EQ(6, clock_replacer.Size());
 
   // Scenario: get three victims from the clock.
   int value;
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(3, value);
 
   // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  // Note that 3 has already been victimized, so it is no longer tracked and cannot be pinned.
+  EXPECT_THROW(clock_replacer.SetEvictable(3, false), Exception);
+  clock_replacer.SetEvictable(4, false);
   EXPECT_EQ(2, clock_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
+  // Scenario: access and unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.RecordAccess(4);
+  clock_replacer.SetEvictable(4, true);
 
   // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
+  clock_replacer.Evict(&value);
   EXPECT_EQ(4, value);
 }
 
@@ -0,0 +1,141 @@
+/**
+ * compressed_page_cache_test.cpp
+ */
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "lzf/lzf.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+TEST(CompressedPageCacheTest, CodecTest) {
+  std::mt19937 gen(0);
+  std::vector<std::vector<char>> inputs;
+  // Scenario: an empty page, a page of repeated records, and random data that does not compress.
+  inputs.emplace_back(BUSTUB_PAGE_SIZE, 0);
+  std::vector<char> records;
+  while (records.size() < BUSTUB_PAGE_SIZE) {
+    auto record = "key=" + std::to_string(records.size() % 97) + ";value=abcdefgh|";
+    records.insert(records.end(), record.begin(), record.end());
+  }
+  records.resize(BUSTUB_PAGE_SIZE);
+  inputs.push_back(records);
+  std::vector<char> random(BUSTUB_PAGE_SIZE);
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  inputs.push_back(random);
+
+  char compressed[BUSTUB_PAGE_SIZE * 2];
+  char output[BUSTUB_PAGE_SIZE];
+  for (auto &input : inputs) {
+    size_t size = lzf::Compress(input.data(), input.size(), compressed, sizeof(compressed));
+    ASSERT_GT(size, 0);
+    ASSERT_EQ(BUSTUB_PAGE_SIZE, lzf::Decompress(compressed, size, output, sizeof(output)));
+    EXPECT_EQ(0, memcmp(input.data(), output, BUSTUB_PAGE_SIZE));
+  }
+  EXPECT_LT(lzf::Compress(inputs[0].data(), BUSTUB_PAGE_SIZE, compressed, sizeof(compressed)), 200);
+  EXPECT_LT(lzf::Compress(inputs[1].data(), BUSTUB_PAGE_SIZE, compressed, sizeof(compressed)), BUSTUB_PAGE_SIZE / 2);
+  // Output that does not fit is reported instead of overflowing.
+  EXPECT_EQ(0, lzf::Compress(random.data(), BUSTUB_PAGE_SIZE, compressed, BUSTUB_PAGE_SIZE - 1));
+  // A truncated stream is rejected.
+  size_t size = lzf::Compress(records.data(), BUSTUB_PAGE_SIZE, compressed, sizeof(compressed));
+  EXPECT_NE(BUSTUB_PAGE_SIZE, lzf::Decompress(compressed, size - 1, output, sizeof(output)));
+}
+
+TEST(CompressedPageCacheTest, SampleTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  // Room for a few dozen compressed pages in each shard.
+  CompressedPageCache cache(disk_manager.get(), 16 * 16 * 128);
+  char page[BUSTUB_PAGE_SIZE];
+  char output[BUSTUB_PAGE_SIZE];
+  bool is_dirty;
+
+  // Scenario: a page taken out of the cache is no longer in it.
+  memset(page, 0, BUSTUB_PAGE_SIZE);
+  snprintf(page, BUSTUB_PAGE_SIZE, "page 0");
+  cache.Put(0, page, true);
+  EXPECT_EQ(1, cache.GetStats().pages_);
+  EXPECT_GT(cache.GetStats().CompressionRatio(), 4);
+  ASSERT_TRUE(cache.Take(0, output, &is_dirty));
+  EXPECT_TRUE(is_dirty);
+  EXPECT_STREQ("page 0", output);
+  EXPECT_FALSE(cache.Take(0, output, &is_dirty));
+  EXPECT_EQ(0, cache.GetStats().pages_);
+
+  // Scenario: over capacity, the oldest pages are dropped and the dirty ones written to disk.
+  for (page_id_t page_id = 0; page_id < 1000; page_id++) {
+    snprintf(page, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    cache.Put(page_id, page, page_id % 2 == 0);
+  }
+  auto stats = cache.GetStats();
+  EXPECT_LT(stats.pages_, 1000);
+  EXPECT_EQ(1000 - stats.pages_, stats.evictions_);
+  EXPECT_GT(stats.writebacks_, 0);
+  ASSERT_TRUE(cache.Take(998, output, &is_dirty));
+  EXPECT_STREQ("page 998", output);
+  disk_manager->ReadPage(0, output);
+  EXPECT_STREQ("page 0", output);
+
+  // Scenario: Flush writes the dirty pages but keeps them cached, Erase drops a page without writing it.
+  cache.Erase(996);
+  EXPECT_GT(cache.Flush(), 0);
+  EXPECT_EQ(0, cache.Flush());
+  disk_manager->ReadPage(994, output);
+  EXPECT_STREQ("page 994", output);
+  memset(output, 0, BUSTUB_PAGE_SIZE);
+  disk_manager->ReadPage(996, output);
+  EXPECT_STRNE("page 996", output);
+  ASSERT_TRUE(cache.Take(994, output, &is_dirty));
+  EXPECT_FALSE(is_dirty);
+}
+
+TEST(CompressedPageCacheTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 50;
+
+  auto saved_size = bpm_compressed_cache_size;
+  bpm_compressed_cache_size = 1 << 20;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  bpm_compressed_cache_size = saved_size;
+  ASSERT_NE(nullptr, bpm->GetCompressedCache());
+
+  // Scenario: a working set five times the buffer pool is served by the compressed cache without disk writes.
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "%d", page_id);
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+      auto guard = bpm->FetchPageWrite(page_id);
+      EXPECT_EQ(std::to_string(page_id), guard.GetData());
+    }
+  }
+  EXPECT_EQ(0, disk_manager->GetStats().writes_);
+  EXPECT_EQ(0, disk_manager->GetStats().reads_);
+  EXPECT_GT(bpm->GetCompressedCache()->GetStats().HitRate(), 0.9);
+
+  // Scenario: a deleted page is not written back by the cache.
+  EXPECT_EQ(true, bpm->DeletePage(0));
+  // Scenario: FlushAllPages also writes the dirty pages held by the cache.
+  bpm->FlushAllPages();
+  char output[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    disk_manager->ReadPage(page_id, output);
+    EXPECT_EQ(std::to_string(page_id), output);
+  }
+  EXPECT_EQ(num_pages - 1, disk_manager->GetStats().writes_);
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+TEST(FrameArenaTest, SampleTest) {
+  FrameArena arena(16, false);
+  EXPECT_EQ(16, arena.NumFrames());
+  EXPECT_EQ(FrameArenaBacking::Pages, arena.Backing());
+
+  // Scenario: every frame is page-aligned, starts zeroed, and does not overlap its neighbours.
+  for (size_t i = 0; i < arena.NumFrames(); ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(i)) % BUSTUB_PAGE_SIZE);
+    EXPECT_EQ(0, arena.GetFrame(i)[0]);
+    EXPECT_EQ(0, arena.GetFrame(i)[BUSTUB_PAGE_SIZE - 1]);
+    memset(arena.GetFrame(i), static_cast<int>(i + 1), BUSTUB_PAGE_SIZE);
+  }
+  for (size_t i = 0; i < arena.NumFrames(); ++i) {
+    EXPECT_EQ(static_cast<char>(i + 1), arena.GetFrame(i)[0]);
+    EXPECT_EQ(static_cast<char>(i + 1), arena.GetFrame(i)[BUSTUB_PAGE_SIZE - 1]);
+  }
+
+  // Scenario: a discarded frame reads as zeros, the other frames keep their data.
+  arena.Discard(3);
+  for (size_t j = 0; j < BUSTUB_PAGE_SIZE; ++j) {
+    ASSERT_EQ(0, arena.GetFrame(3)[j]);
+  }
+  EXPECT_EQ(3, arena.GetFrame(2)[BUSTUB_PAGE_SIZE - 1]);
+  EXPECT_EQ(5, arena.GetFrame(4)[0]);
+}
+
+TEST(FrameArenaTest, HugePageTest) {
+  // Scenario: a large arena asks for huge pages and falls back gracefully if the system has none.
+  const size_t num_frames = 2048;
+  FrameArena arena(num_frames, true);
+  for (size_t i = 0; i < num_frames; ++i) {
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrame(i)) % BUSTUB_PAGE_SIZE);
+    arena.GetFrame(i)[0] = 'x';
+  }
+  arena.Discard(num_frames - 1);
+  EXPECT_EQ(0, arena.GetFrame(num_frames - 1)[0]);
+  EXPECT_EQ('x', arena.GetFrame(0)[0]);
+}
+
+TEST(FrameArenaTest, BufferPoolTest) {
+  // Scenario: the book-keeping information of neighbouring frames never shares a cache line.
+  static_assert(alignof(Page) == BUSTUB_CACHE_LINE_SIZE);
+  static_assert(sizeof(Page) % BUSTUB_CACHE_LINE_SIZE == 0);
+
+  const size_t buffer_pool_size = 100;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: every frame of the buffer pool is page-aligned, also after the pool grows and shrinks.
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size * 3));
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    auto *frame = bpm->GetFrame(i);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame) % BUSTUB_CACHE_LINE_SIZE);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frame->GetData()) % BUSTUB_PAGE_SIZE);
+  }
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+  }
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size * 2));
+  page_id_t page_id;
+  auto guard = bpm->NewPageGuarded(&page_id);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(guard.GetData()) % BUSTUB_PAGE_SIZE);
+  guard.Drop();
+
+  {
+    auto read_guard = bpm->FetchPageRead(0);
+    EXPECT_STREQ("page 0", read_guard.GetData());
+  }
+}
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -95,4 +96,68 @@ TEST(LRUKReplacerTest, SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, FullHistoryOrderTest) {
+  LRUKReplacer lru_replacer(4, 2);
+
+  // Scenario: frames 0..3 all reach k accesses. Their k-th most recent accesses are 0 -> 1, 1 -> 3, 2 -> 5, 3 -> 7.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Touch frame 0 twice more, its k-th most recent access is now the newest one.
+  lru_replacer.RecordAccess(0);
+  lru_replacer.RecordAccess(0);
+  // Frame 2 only gets one more access, which moves its k-th most recent access to its previous second access.
+  lru_replacer.RecordAccess(2);
+
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+
+  // Frame ids must be smaller than the number of frames.
+  ASSERT_THROW(lru_replacer.RecordAccess(4), Exception);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: frames 1 and 2 are hot, frame 3 was looked up once, frames 4 and 5 were only touched by a scan.
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(2, AccessType::Get);
+  lru_replacer.RecordAccess(2, AccessType::Get);
+  lru_replacer.RecordAccess(3, AccessType::Get);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  lru_replacer.RecordAccess(5, AccessType::Scan);
+  lru_replacer.RecordAccess(4, AccessType::Scan);
+  // A scan over a hot frame does not refresh it: frame 1 is still the coldest of the hot frames.
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  // A frame first brought in by a scan and then looked up is a regular frame with a single reference.
+  lru_replacer.RecordAccess(6, AccessType::Scan);
+  lru_replacer.RecordAccess(6, AccessType::Get);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(6, lru_replacer.Size());
+
+  // Scanned frames go first in FIFO order, then frames with less than k references, then the hot frames.
+  int value;
+  for (frame_id_t expected : {4, 5, 3, 6, 1, 2}) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
 }  // namespace bustub
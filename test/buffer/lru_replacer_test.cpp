@@ -15,47 +15,55 @@
 #include <vector>
 
 #include "buffer/lru_replacer.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(LRUReplacerTest, DISABLED_SampleTest) {
+TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
-  lru_replacer.Unpin(1);
-  lru_replacer.Unpin(2);
-  lru_replacer.Unpin(3);
-  lru_replacer.Unpin(4);
-  lru_replacer.Unpin(5);
-  lru_replacer.Unpin(6);
-  lru_replacer.Unpin(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.SetEvictable(1, true);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.SetEvictable(2, true);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.SetEvictable(3, true);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(4, true);
+  lru_replacer.RecordAccess(5);
+  lru_replacer.SetEvictable(5, true);
+  lru_replacer.RecordAccess(6);
+  lru_replacer.SetEvictable(6, true);
+  lru_replacer.SetEvictable(1, true);
   EXPECT_EQ(6, lru_replacer.Size());
 
   // Scenario: get three victims from the lru.
   int value;
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(1, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(2, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(3, value);
 
   // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  lru_replacer.Pin(3);
-  lru_replacer.Pin(4);
+  // Note that 3 has already been victimized, so it is no longer tracked and cannot be pinned.
+  EXPECT_THROW(lru_replacer.SetEvictable(3, false), Exception);
+  lru_replacer.SetEvictable(4, false);
   EXPECT_EQ(2, lru_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  lru_replacer.Unpin(4);
+  // Scenario: access and unpin 4. We expect that 4 becomes the most recently used frame.
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(4, true);
 
   // Scenario: continue looking for victims. We expect these victims.
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(5, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(6, value);
-  lru_replacer.Victim(&value);
+  lru_replacer.Evict(&value);
   EXPECT_EQ(4, value);
 }
 
@@ -0,0 +1,111 @@
+/**
+ * page_table_test.cpp
+ */
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: ids of one partition are strided, they must still be found.
+  for (int i = 0; i < 8; i++) {
+    page_table.Insert(i * 4 + 1, i);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(page_table.Find(i * 4 + 1, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+
+  // Scenario: erasing does not lose the entries probed after it.
+  EXPECT_TRUE(page_table.Erase(5));
+  EXPECT_FALSE(page_table.Erase(5));
+  EXPECT_FALSE(page_table.Find(5, &frame_id));
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(i != 1, page_table.Find(i * 4 + 1, &frame_id));
+  }
+  page_table.Insert(100, 1);
+  ASSERT_TRUE(page_table.Find(100, &frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  size_t count = 0;
+  page_table.ForEach([&count](page_id_t, frame_id_t) { count++; });
+  EXPECT_EQ(8, count);
+}
+
+TEST(PageTableTest, RandomTest) {
+  const size_t max_entries = 64;
+  PageTable page_table(max_entries);
+  std::map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<page_id_t> dist(0, 200);
+
+  for (int round = 0; round < 20000; round++) {
+    page_id_t page_id = dist(gen);
+    if (expected.count(page_id) > 0) {
+      EXPECT_TRUE(page_table.Erase(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < max_entries) {
+      page_table.Insert(page_id, round % 1000);
+      expected[page_id] = round % 1000;
+    }
+  }
+  EXPECT_EQ(expected.size(), page_table.Size());
+  for (page_id_t page_id = 0; page_id <= 200; page_id++) {
+    frame_id_t frame_id;
+    ASSERT_EQ(expected.count(page_id) > 0, page_table.Find(page_id, &frame_id));
+    if (expected.count(page_id) > 0) {
+      EXPECT_EQ(expected[page_id], frame_id);
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentReadTest) {
+  // Readers running next to a writer may miss entries that are being moved, but never see a wrong frame.
+  PageTable page_table(32);
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> found{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < 16; page_id++) {
+          frame_id_t frame_id;
+          if (page_table.Find(page_id, &frame_id)) {
+            EXPECT_EQ(page_id, frame_id);
+            found++;
+          }
+        }
+      }
+    });
+  }
+  std::mt19937 gen(7);
+  for (int round = 0; round < 100000; round++) {
+    page_id_t page_id = static_cast<page_id_t>(gen() % 16 + 16);
+    if (!page_table.Erase(page_id)) {
+      page_table.Insert(page_id, page_id);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_GT(found, 0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // With 8 frames, A1in has a target size of 2 and A1out remembers 4 pages.
+  TwoQueueReplacer replacer(8);
+  int value;
+
+  // Scenario: frames 0..3 hold pages 100..103, each accessed once. They all sit in A1in, which is over its target.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Unknown, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: page 100 comes back while it is remembered in A1out, so it goes to Am. Page 104 is read by a scan.
+  replacer.RecordAccess(0, AccessType::Unknown, 100);
+  replacer.SetEvictable(0, true);
+  replacer.RecordAccess(1, AccessType::Scan, 104);
+  replacer.SetEvictable(1, true);
+  replacer.RecordAccess(4, AccessType::Unknown, 105);
+  replacer.SetEvictable(4, true);
+  replacer.RecordAccess(5, AccessType::Unknown, 106);
+  replacer.SetEvictable(5, true);
+
+  // A1in holds frames 2, 3, 1, 4, 5 and is drained down to its target before the hot frame 0 is touched.
+  for (frame_id_t expected : {2, 3, 1}) {
+    ASSERT_TRUE(replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(3, replacer.Size());
+
+  // Scenario: page 102 was remembered in A1out and goes to Am, page 104 was only scanned and goes to A1in again.
+  replacer.RecordAccess(1, AccessType::Unknown, 104);
+  replacer.SetEvictable(1, true);
+  replacer.RecordAccess(2, AccessType::Unknown, 102);
+  replacer.SetEvictable(2, true);
+
+  // A1in is over its target once more, then Am is evicted in LRU order, then the rest of A1in.
+  for (frame_id_t expected : {4, 0, 2, 5, 1}) {
+    ASSERT_TRUE(replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_FALSE(replacer.Evict(&value));
+  ASSERT_EQ(0, replacer.Size());
+
+  // Pinned frames are never evicted, and only evictable frames can be removed.
+  replacer.RecordAccess(6, AccessType::Unknown, 107);
+  ASSERT_FALSE(replacer.Evict(&value));
+  ASSERT_THROW(replacer.Remove(6), Exception);
+  replacer.SetEvictable(6, true);
+  replacer.Remove(6);
+  ASSERT_EQ(0, replacer.Size());
+  ASSERT_THROW(replacer.RecordAccess(8), Exception);
+}
+
+TEST(TwoQueueReplacerTest, EvictFrameTest) {
+  TwoQueueReplacer replacer(8);
+  int value;
+
+  // Scenario: frames 0..2 hold pages 100..102 in A1in, frame 1 is picked by the caller instead of frame 0.
+  for (frame_id_t frame_id = 0; frame_id < 3; frame_id++) {
+    replacer.RecordAccess(frame_id, AccessType::Unknown, 100 + frame_id);
+    replacer.SetEvictable(frame_id, true);
+  }
+  replacer.EvictFrame(1);
+  ASSERT_EQ(2, replacer.Size());
+
+  // Page 101 is remembered in A1out like a regular victim, so its return goes to Am instead of A1in.
+  replacer.RecordAccess(1, AccessType::Unknown, 101);
+  replacer.SetEvictable(1, true);
+  replacer.RecordAccess(3, AccessType::Unknown, 103);
+  replacer.SetEvictable(3, true);
+  ASSERT_TRUE(replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Untracked frames are ignored and pinned frames cannot be picked.
+  replacer.EvictFrame(4);
+  replacer.SetEvictable(2, false);
+  ASSERT_THROW(replacer.EvictFrame(2), Exception);
+  replacer.SetEvictable(2, true);
+
+  // A1in is back at its target, so page 101 in Am goes first.
+  for (frame_id_t expected : {1, 2, 3}) {
+    ASSERT_TRUE(replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using bustub::DiskManagerUnlimitedMemory;
+
+using BulkLoadTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// 从最左边的叶节点开始，检查每个叶节点的大小和high key
+void CheckLeaves(BufferPoolManager *bpm, page_id_t root_page_id, int leaf_max_size,
+                 const GenericComparator<8> &comparator) {
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+  ReadPageGuard guard = bpm->FetchPageRead(root_page_id);
+  bool is_root = true;
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+    guard = bpm->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+    is_root = false;
+  }
+  while (true) {
+    auto leaf_page = guard.As<LeafPage>();
+    EXPECT_LT(leaf_page->GetSize(), leaf_max_size);
+    if (!is_root) {
+      EXPECT_GE(leaf_page->GetSize(), leaf_page->GetMinSize());
+    }
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    auto high_key = leaf_page->GetHighKey();
+    guard = bpm->FetchPageRead(next_page_id);
+    EXPECT_EQ(comparator(high_key, guard.As<LeafPage>()->KeyAt(0)), 0);
+  }
+}
+
+TEST(BPlusTreeTests, BulkLoadEmptyTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator, 4, 4);
+
+  ASSERT_TRUE(tree.BulkLoad({}));
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(tree.GetRootPageId(), INVALID_PAGE_ID);
+  EXPECT_TRUE(tree.Begin() == tree.End());
+
+  // 空树bulk load之后还可以正常插入
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(1);
+  ASSERT_TRUE(tree.Insert(index_key, RID(0, 1)));
+  EXPECT_FALSE(tree.IsEmpty());
+  // 非空的树不能bulk load
+  EXPECT_FALSE(tree.BulkLoad({{index_key, RID(0, 2)}}));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTests, BulkLoadSingleLeafTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BulkLoadTree tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator, 8, 4);
+
+  // 乱序并且有重复的key，重复的key保留第一个
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int64_t key : {5, 3, 1, 4, 3, 2}) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(static_cast<page_id_t>(entries.size()), key));
+  }
+  ASSERT_TRUE(tree.BulkLoad(entries));
+
+  auto root_guard = bpm->FetchPageRead(tree.GetRootPageId());
+  ASSERT_TRUE(root_guard.As<BPlusTreePage>()->IsLeafPage());
+  EXPECT_EQ(root_guard.As<BPlusTreePage>()->GetSize(), 5);
+  root_guard.Drop();
+
+  int64_t current_key = 1;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 6);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(3);
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(rids[0].GetPageId(), 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTests, BulkLoadMultiLevelTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  const int leaf_max_size = 5;
+  BulkLoadTree tree("foo_pk", header_page->GetPageId(), bpm.get(), comparator, leaf_max_size, 4);
+
+  // 只bulk load偶数key
+  const int64_t scale = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < scale; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (auto key : keys) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(0, key));
+  }
+  ASSERT_TRUE(tree.BulkLoad(entries, 0.6));
+
+  // 至少有三层
+  {
+    auto guard = bpm->FetchPageRead(tree.GetRootPageId());
+    ASSERT_FALSE(guard.As<BPlusTreePage>()->IsLeafPage());
+    auto internal_page = guard.As<BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>>();
+    guard = bpm->FetchPageRead(internal_page->ValueAt(0));
+    ASSERT_FALSE(guard.As<BPlusTreePage>()->IsLeafPage());
+  }
+  CheckLeaves(bpm.get(), tree.GetRootPageId(), leaf_max_size, comparator);
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < scale; key++) {
+    rids.clear();
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 0);
+  }
+
+  // bulk load之后的树可以继续插入和删除
+  for (int64_t key = 1; key < scale; key += 2) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, RID(0, key)));
+  }
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, scale);
+
+  for (int64_t key = 0; key < scale; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, nullptr);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+TEST(BPlusTreeTests, BulkLoadCreateIndexTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto *txn = new Transaction(0);
+
+  auto schema = ParseCreateStatement("a integer,b integer");
+  auto key_schema = ParseCreateStatement("a integer");
+  auto *empty_table = catalog->CreateTable(txn, "empty", *schema);
+  auto *table = catalog->CreateTable(txn, "t", *schema);
+
+  // 空表创建索引
+  auto *empty_index = catalog->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+      txn, "empty_a", "empty", empty_table->schema_, *key_schema, {0}, TWO_INTEGER_SIZE, IntegerHashFunctionType{});
+  ASSERT_NE(empty_index, Catalog::NULL_INDEX_INFO);
+  auto *empty_tree = dynamic_cast<BPlusTreeIndexForTwoIntegerColumn *>(empty_index->index_.get());
+  EXPECT_TRUE(empty_tree->GetBeginIterator() == empty_tree->GetEndIterator());
+
+  // 有数据的表创建索引，已经删除的tuple不进入索引
+  const int scale = 1000;
+  std::vector<RID> table_rids;
+  for (int i = 0; i < scale; i++) {
+    Tuple tuple({Value(TypeId::INTEGER, scale - i), Value(TypeId::INTEGER, i)}, schema.get());
+    table_rids.push_back(*table->table_->InsertTuple({INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+  table->table_->UpdateTupleMeta({INVALID_TXN_ID, INVALID_TXN_ID, true}, table_rids[0]);
+
+  auto *index_info = catalog->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+      txn, "t_a", "t", table->schema_, *key_schema, {0}, TWO_INTEGER_SIZE, IntegerHashFunctionType{});
+  ASSERT_NE(index_info, Catalog::NULL_INDEX_INFO);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < scale; i++) {
+    rids.clear();
+    Tuple key({Value(TypeId::INTEGER, scale - i)}, key_schema.get());
+    index_info->index_->ScanKey(key, &rids, txn);
+    if (i == 0) {
+      EXPECT_TRUE(rids.empty());
+    } else {
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0], table_rids[i]);
+    }
+  }
+
+  delete txn;
+}
+
+}  // namespace bustub
@@ -433,4 +433,189 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, MixTest3) {
+  // 小fan-out，降序插入让最左路径频繁分裂，乐观和悲观的插入删除交替进行
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+
+  int64_t total_keys = 2000;
+  std::vector<int64_t> keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = total_keys; key > 0; key--) {
+    keys.push_back(key);
+    if (key % 2 == 1) {
+      remove_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+
+  std::vector<int64_t> left_keys;
+  for (int64_t key = 2; key <= total_keys; key += 2) {
+    left_keys.push_back(key);
+  }
+  LookupHelper(&tree, left_keys, 1);
+
+  int64_t current_key = 2;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 2;
+  }
+  EXPECT_EQ(current_key, total_keys + 2);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // 乐观查询和插入删除同时进行，保留的key一直能查到
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+  tree.SetOptimisticReads(true);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  for (int64_t i = 1; i <= 2000; i++) {
+    if (i % 4 == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys);
+
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] { InsertHelperSplit(&tree, dynamic_keys, 2, 0); });
+  threads.emplace_back([&] { InsertHelperSplit(&tree, dynamic_keys, 2, 1); });
+  threads.emplace_back([&] {
+    for (int round = 0; round < 5; round++) {
+      LookupHelper(&tree, perserved_keys, 2);
+    }
+  });
+  threads.emplace_back([&] { DeleteHelperSplit(&tree, dynamic_keys, 2, 0); });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  LookupHelper(&tree, perserved_keys, 3);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, OptimisticLookupNoPinTest) {
+  // 所有page都在buffer pool中时，乐观查询不pin page
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(1000, disk_manager.get());
+
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 500; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  tree.SetOptimisticReads(true);
+  auto before = bpm->GetStats();
+  LookupHelper(&tree, keys, 1);
+  auto after = bpm->GetStats();
+  EXPECT_EQ(before.hits_, after.hits_);
+  EXPECT_EQ(before.misses_, after.misses_);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, BLinkMixTest) {
+  // B-link协议：并发插入删除，查询时移向右边的节点
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4,
+                                                          BPlusTreeProtocol::BLink);
+
+  int64_t total_keys = 2000;
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 1; key <= total_keys; key++) {
+    if (key % 3 == 0) {
+      perserved_keys.push_back(key);
+    } else {
+      remove_keys.push_back(key);
+    }
+  }
+  InsertHelper(&tree, perserved_keys);
+
+  // 插入时加读锁查询，删除时乐观查询
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < 3; thread_itr++) {
+    threads.emplace_back([&, thread_itr] { InsertHelperSplit(&tree, remove_keys, 3, thread_itr); });
+  }
+  threads.emplace_back([&] { LookupHelper(&tree, perserved_keys, 1); });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  tree.SetOptimisticReads(true);
+  for (uint64_t thread_itr = 0; thread_itr < 2; thread_itr++) {
+    threads.emplace_back([&, thread_itr] { DeleteHelperSplit(&tree, remove_keys, 2, thread_itr); });
+  }
+  threads.emplace_back([&] { LookupHelper(&tree, perserved_keys, 2); });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t current_key = 3;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 3;
+  }
+  EXPECT_EQ(current_key, total_keys / 3 * 3 + 3);
+
+  // 删除所有key后树是空的
+  DeleteHelperSplit(&tree, perserved_keys, 1, 0);
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -12,6 +12,8 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -186,4 +188,62 @@ TEST(BPlusTreeTests, InsertTest3) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto protocol : {BPlusTreeProtocol::LatchCrabbing, BPlusTreeProtocol::BLink}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto *bpm = new BufferPoolManager(50, disk_manager.get());
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    // create b+ tree
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4,
+                                                             4, protocol);
+    GenericKey<8> index_key;
+
+    // 空树上批量插入
+    std::vector<std::pair<GenericKey<8>, RID>> entries;
+    for (int64_t key = 0; key < 30; key += 3) {
+      index_key.SetFromInteger(key);
+      entries.emplace_back(index_key, RID(0, key));
+    }
+    EXPECT_EQ(tree.InsertBatch(entries), entries.size());
+
+    // 已有的key和batch内重复的key不插入，batch中间的key会让叶节点分裂
+    entries.clear();
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 300; key++) {
+      keys.push_back(key);
+      if (key % 7 == 0) {
+        keys.push_back(key);
+      }
+    }
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      entries.emplace_back(index_key, RID(0, key));
+    }
+    EXPECT_EQ(tree.InsertBatch(entries), 290);
+
+    std::vector<RID> rids;
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key++;
+    }
+    EXPECT_EQ(current_key, 300);
+    for (int64_t key = 0; key < 300; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+  }
+}
 }  // namespace bustub
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <fstream>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -72,6 +75,266 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  const int num_pages = 8;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<const char *> run;
+  for (int i = 0; i < num_pages; i++) {
+    std::memset(pages[i].data(), i + 1, BUSTUB_PAGE_SIZE);
+    run.push_back(pages[i].data());
+  }
+  auto dm = DiskManager("test.db");
+  dm.WritePagesAsync(3, run).wait();
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  for (int i = 0; i < num_pages; i++) {
+    dm.ReadPage(3 + i, buf);
+    EXPECT_EQ(std::memcmp(buf, pages[i].data(), sizeof(buf)), 0);
+  }
+  // the gap before the run reads as zeros
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(0, buf[0]);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SyncPolicyTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(DiskSyncPolicy::OnCheckpoint, dm.GetSyncPolicy());
+
+  // Scenario: on_checkpoint only syncs when asked to.
+  dm.WritePage(0, data);
+  dm.SyncBatch();
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.Sync();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+
+  // Scenario: per_batch syncs at the end of every batch.
+  dm.SetSyncPolicy(DiskSyncPolicy::PerBatch);
+  dm.WritePage(1, data);
+  dm.WritePage(2, data);
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  dm.SyncBatch();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+
+  // Scenario: per_write syncs every page.
+  dm.SetSyncPolicy(DiskSyncPolicy::PerWrite);
+  dm.WritePage(3, data);
+  dm.WritePage(4, data);
+  EXPECT_EQ(4, dm.GetNumSyncs());
+  EXPECT_EQ(5, dm.GetNumWrites());
+  dm.ShutDown();
+
+  EXPECT_EQ(DiskSyncPolicy::PerBatch, DiskSyncPolicyFromString("PER-BATCH"));
+  EXPECT_EQ(std::nullopt, DiskSyncPolicyFromString("sometimes"));
+  EXPECT_EQ("on_checkpoint", DiskSyncPolicyToString(DiskSyncPolicy::OnCheckpoint));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PerWriteSkipsFreePageMapTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file, DiskSyncPolicy::PerWrite);
+    dm.WritePage(0, data);
+    dm.WritePage(1, data);
+    dm.DeallocatePage(1);
+    // a per_write sync only covers the data, the free page map waits for the next full sync
+    dm.WritePage(2, data);
+    EXPECT_EQ(3, dm.GetNumSyncs());
+  }
+  {
+    auto dm = DiskManager(db_file, DiskSyncPolicy::PerWrite);
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    dm.DeallocatePage(1);
+    dm.Sync();
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(1, dm.GetNumFreePages());
+    EXPECT_TRUE(dm.IsPageFree(1));
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PerWriteAllocationTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file, DiskSyncPolicy::PerWrite);
+    for (page_id_t page_id = 0; page_id < 3; page_id++) {
+      dm.WritePage(page_id, data);
+    }
+    dm.DeallocatePage(1);
+    dm.Sync();
+  }
+  {
+    // a reused page id is taken out of the map on disk together with the per_write sync of its new data
+    auto dm = DiskManager(db_file, DiskSyncPolicy::PerWrite);
+    EXPECT_TRUE(dm.IsPageFree(1));
+    EXPECT_EQ(1, dm.AllocateFreePage(3));
+    std::memset(data, 1, sizeof(data));
+    dm.WritePage(1, data);
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    EXPECT_FALSE(dm.IsPageFree(1));
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(3));
+    char buf[BUSTUB_PAGE_SIZE] = {0};
+    dm.ReadPage(1, buf);
+    EXPECT_EQ(1, buf[0]);
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int num_pages = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm, tid]() {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (int page_id = tid; page_id < num_pages; page_id += num_threads) {
+        std::memset(data, page_id, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Pages written by other threads are all visible, and the file ends right after the last page.
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  for (int page_id = 0; page_id < num_pages; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(static_cast<char>(page_id), buf[BUSTUB_PAGE_SIZE - 1]);
+  }
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_pages, buf);
+  EXPECT_EQ(0, buf[0]);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageMapTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      std::memset(data, page_id + 1, sizeof(data));
+      dm.WritePage(page_id, data);
+    }
+    EXPECT_EQ(10, dm.GetNumPages());
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(4);
+    dm.DeallocatePage(3);
+    EXPECT_EQ(3, dm.GetNumFreePages());
+
+    // the lowest free page of the stripe is reused first, pages above the limit are never handed out
+    EXPECT_EQ(4, dm.AllocateFreePage(10, 2, 0));
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(10, 2, 0));
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(3));
+    EXPECT_EQ(3, dm.AllocateFreePage(10));
+    dm.DeallocatePage(9);
+    dm.DeallocatePage(8);
+    dm.ClaimPage(8);
+    EXPECT_FALSE(dm.IsPageFree(8));
+
+    // Scenario: free pages are counted per stripe, and the counts follow pages freed and reused afterwards.
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(10, 4, 0));
+    dm.DeallocatePage(8);
+    EXPECT_EQ(8, dm.AllocateFreePage(10, 4, 0));
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(10, 4, 0));
+    EXPECT_EQ(INVALID_PAGE_ID, dm.AllocateFreePage(9, 4, 1));
+    EXPECT_EQ(7, dm.AllocateFreePage(10, 4, 3));
+    dm.DeallocatePage(7);
+    dm.ShutDown();
+  }
+
+  // Scenario: the free page map survives a restart, and the map pages do not overlap the data pages.
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(2, dm.GetNumFreePages());
+    EXPECT_TRUE(dm.IsPageFree(7));
+    EXPECT_TRUE(dm.IsPageFree(9));
+    for (page_id_t page_id = 0; page_id < 10; page_id++) {
+      dm.ReadPage(page_id, buf);
+      EXPECT_EQ(page_id + 1, buf[0]);
+    }
+
+    // Scenario: compaction only drops the free pages at the end of the file.
+    EXPECT_EQ(1, dm.TruncateFreeTail());
+    EXPECT_EQ(9, dm.GetNumPages());
+    EXPECT_EQ(1, dm.GetNumFreePages());
+    EXPECT_EQ(0, dm.TruncateFreeTail());
+    dm.DeallocatePage(8);
+    EXPECT_EQ(2, dm.TruncateFreeTail());
+    EXPECT_EQ(7, dm.GetNumPages());
+    dm.ShutDown();
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(7, dm.GetNumPages());
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    dm.ReadPage(6, buf);
+    EXPECT_EQ(7, buf[0]);
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FileHeaderTest) {
+  std::string db_file("test.db");
+  EXPECT_FALSE(DiskManager::ReadFilePageSize(db_file).has_value());
+
+  // Scenario: a new db file records the page size of this build, and is opened again without complaint.
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(0, dm.GetNumPages());
+    dm.ShutDown();
+  }
+  EXPECT_EQ(BUSTUB_PAGE_SIZE, DiskManager::ReadFilePageSize(db_file));
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(0, dm.GetNumPages());
+    dm.ShutDown();
+  }
+
+  // Scenario: a file created with another page size is refused, and so is a file that is not a db file.
+  uint32_t other_page_size = BUSTUB_PAGE_SIZE * 2;
+  {
+    std::fstream file(db_file, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(12);
+    file.write(reinterpret_cast<const char *>(&other_page_size), sizeof(other_page_size));
+  }
+  EXPECT_EQ(other_page_size, DiskManager::ReadFilePageSize(db_file));
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+  {
+    std::ofstream file(db_file, std::ios::binary | std::ios::trunc);
+    file << "this is not a db file";
+  }
+  EXPECT_FALSE(DiskManager::ReadFilePageSize(db_file).has_value());
+  EXPECT_THROW(DiskManager{db_file}, Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_uring_test.cpp
+//
+// Identification: test/storage/disk_manager_uring_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_uring.h"
+
+namespace bustub {
+
+class DiskManagerUringTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, AsyncReadWriteTest) {
+  const int num_pages = 300;
+  // 比queue depth更多的请求，测试提交时的等待
+  auto dm = DiskManagerUring("test.db", DiskSyncPolicy::OnCheckpoint, false, 16);
+  if (!dm.IsUringEnabled()) {
+    GTEST_SKIP() << "io_uring is unavailable";
+  }
+
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<void>> futures;
+  for (int page_id = 0; page_id < num_pages; page_id++) {
+    std::memset(pages[page_id].data(), page_id, BUSTUB_PAGE_SIZE);
+    futures.push_back(dm.WritePageAsync(page_id, pages[page_id].data()));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  futures.clear();
+  for (int page_id = num_pages - 1; page_id >= 0; page_id--) {
+    futures.push_back(dm.ReadPageAsync(page_id, bufs[page_id].data()));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  for (int page_id = 0; page_id < num_pages; page_id++) {
+    EXPECT_EQ(0, std::memcmp(pages[page_id].data(), bufs[page_id].data(), BUSTUB_PAGE_SIZE));
+  }
+
+  // Reading past the end of the file yields a zeroed page.
+  std::memset(bufs[0].data(), 1, BUSTUB_PAGE_SIZE);
+  dm.ReadPage(num_pages + 10, bufs[0].data());
+  EXPECT_EQ(0, bufs[0][0]);
+  EXPECT_EQ(0, bufs[0][BUSTUB_PAGE_SIZE - 1]);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, DirectIOTest) {
+  auto dm = DiskManagerUring("test.db", DiskSyncPolicy::PerWrite, true);
+  char data[BUSTUB_PAGE_SIZE + 1] = {0};
+  char buf[BUSTUB_PAGE_SIZE + 1] = {0};
+  // 故意使用没有对齐的buffer
+  std::strncpy(data + 1, "A test string.", BUSTUB_PAGE_SIZE);
+  dm.WritePage(3, data + 1);
+  dm.ReadPage(3, buf + 1);
+  EXPECT_EQ(0, std::memcmp(data + 1, buf + 1, BUSTUB_PAGE_SIZE));
+  if (dm.IsUringEnabled()) {
+    EXPECT_EQ(1, dm.GetNumSyncs());
+  }
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerUringTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 64;
+  auto dm = std::make_unique<DiskManagerUring>("test.db", DiskSyncPolicy::OnCheckpoint, true);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, dm.get());
+
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(4, bpm->PrefetchPages({0, 1, 2, 3}));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); page_id++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), ("page " + std::to_string(page_id)).c_str()));
+  }
+  bpm.reset();
+  dm->ShutDown();
+}
+
+}  // namespace bustub
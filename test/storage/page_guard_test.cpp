@@ -10,9 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/disk/disk_manager_memory.h"
@@ -241,4 +246,67 @@ TEST(PageGuardTest, MoveTest) {
   disk_manager->ShutDown();
 }
 
+TEST(PageGuardTest, UpgradeTest) {
+  const size_t buffer_pool_size = 5;
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "initial");
+  }
+
+  // Scenario: an upgradable guard shares the page with readers but keeps writers out.
+  auto upgradable_guard = bpm->FetchPageUpgradable(page_id);
+  auto read_guard = bpm->FetchPageRead(page_id);
+  EXPECT_STREQ("initial", upgradable_guard.GetData());
+  EXPECT_STREQ("initial", read_guard.GetData());
+  std::atomic<bool> written{false};
+  std::thread writer([&] {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    snprintf(write_guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "writer");
+    written = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(written);
+
+  // Scenario: a reader cannot upgrade while an upgradable guard is held, and keeps its read latch.
+  EXPECT_FALSE(read_guard.TryUpgrade().has_value());
+  EXPECT_STREQ("initial", read_guard.GetData());
+  read_guard.Drop();
+
+  // Scenario: the upgrade sees the page as it was read and goes before the waiting writer.
+  auto write_guard = upgradable_guard.Upgrade();
+  EXPECT_EQ(page_id, write_guard.PageId());
+  EXPECT_STREQ("initial", write_guard.GetData());
+  snprintf(write_guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "upgraded");
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(written);
+  write_guard.Drop();
+  writer.join();
+  EXPECT_TRUE(written);
+
+  // Scenario: a lone reader upgrades; the moved-from guards are empty and the pins are released once.
+  {
+    auto reader = bpm->FetchPageRead(page_id);
+    EXPECT_STREQ("writer", reader.GetData());
+    auto upgraded = reader.TryUpgrade();
+    ASSERT_TRUE(upgraded.has_value());
+    snprintf(upgraded->AsMut<char>(), BUSTUB_PAGE_SIZE, "try upgraded");
+  }
+  {
+    auto reader = bpm->FetchPageRead(page_id);
+    EXPECT_STREQ("try upgraded", reader.GetData());
+  }
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t other_page_id;
+    guards.push_back(bpm->NewPageGuarded(&other_page_id));
+    ASSERT_NE(nullptr, guards.back().GetData());
+  }
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
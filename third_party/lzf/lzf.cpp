@@ -0,0 +1,149 @@
+/*
+ * Minimal LZ77 codec producing the LZF stream format of liblzf. See lzf.h for the format.
+ */
+
+#include "lzf.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace lzf {
+
+namespace {
+
+constexpr unsigned HASH_LOG = 13;
+constexpr size_t MAX_LITERAL = 1 << 5;
+constexpr size_t MAX_OFFSET = 1 << 13;
+constexpr size_t MAX_REF = (1 << 8) + (1 << 3);
+
+inline auto Hash(const uint8_t *p) -> uint32_t {
+  uint32_t v = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+  return (v * 2654435761U) >> (32 - HASH_LOG);
+}
+
+}  // namespace
+
+auto Compress(const void *in, size_t in_len, void *out, size_t out_len) -> size_t {
+  const auto *ip = static_cast<const uint8_t *>(in);
+  auto *op = static_cast<uint8_t *>(out);
+  if (in_len == 0 || out_len < 2) {
+    return 0;
+  }
+  // positions + 1 of the last occurrence of each 3-byte prefix, 0 if none
+  uint32_t table[1 << HASH_LOG];
+  memset(table, 0, sizeof(table));
+
+  size_t i = 0;
+  size_t o = 1;  // op[0] is the control byte of the first literal run
+  size_t lit = 0;
+  auto emit_literal = [&]() -> bool {
+    // the byte itself plus the control byte of a following run
+    if (o + 2 > out_len) {
+      return false;
+    }
+    op[o++] = ip[i++];
+    if (++lit == MAX_LITERAL) {
+      op[o - lit - 1] = static_cast<uint8_t>(lit - 1);
+      lit = 0;
+      o++;
+    }
+    return true;
+  };
+
+  while (i + 2 < in_len) {
+    uint32_t h = Hash(ip + i);
+    size_t ref = table[h];
+    table[h] = static_cast<uint32_t>(i + 1);
+    if (ref != 0 && i - ref < MAX_OFFSET && ip[ref - 1] == ip[i] && ip[ref] == ip[i + 1] &&
+        ip[ref + 1] == ip[i + 2]) {
+      ref--;
+      size_t off = i - ref - 1;
+      size_t max_len = in_len - i < MAX_REF ? in_len - i : MAX_REF;
+      size_t len = 3;
+      while (len < max_len && ip[ref + len] == ip[i + len]) {
+        len++;
+      }
+      // close the pending literal run, dropping its control byte if it is empty
+      if (lit == 0) {
+        o--;
+      } else {
+        op[o - lit - 1] = static_cast<uint8_t>(lit - 1);
+      }
+      if (o + 4 > out_len) {
+        return 0;
+      }
+      size_t l = len - 2;
+      if (l < 7) {
+        op[o++] = static_cast<uint8_t>((off >> 8) + (l << 5));
+      } else {
+        op[o++] = static_cast<uint8_t>((off >> 8) + (7 << 5));
+        op[o++] = static_cast<uint8_t>(l - 7);
+      }
+      op[o++] = static_cast<uint8_t>(off);
+      o++;
+      lit = 0;
+      // index the positions inside the match so that later data can refer to them
+      for (size_t j = i + 1; j < i + len && j + 2 < in_len; j++) {
+        table[Hash(ip + j)] = static_cast<uint32_t>(j + 1);
+      }
+      i += len;
+      continue;
+    }
+    if (!emit_literal()) {
+      return 0;
+    }
+  }
+  while (i < in_len) {
+    if (!emit_literal()) {
+      return 0;
+    }
+  }
+  if (lit == 0) {
+    o--;
+  } else {
+    op[o - lit - 1] = static_cast<uint8_t>(lit - 1);
+  }
+  return o;
+}
+
+auto Decompress(const void *in, size_t in_len, void *out, size_t out_len) -> size_t {
+  const auto *ip = static_cast<const uint8_t *>(in);
+  auto *op = static_cast<uint8_t *>(out);
+  size_t i = 0;
+  size_t o = 0;
+  while (i < in_len) {
+    size_t ctrl = ip[i++];
+    if (ctrl < MAX_LITERAL) {
+      size_t len = ctrl + 1;
+      if (i + len > in_len || o + len > out_len) {
+        return 0;
+      }
+      memcpy(op + o, ip + i, len);
+      i += len;
+      o += len;
+      continue;
+    }
+    size_t len = ctrl >> 5;
+    if (len == 7) {
+      if (i >= in_len) {
+        return 0;
+      }
+      len += ip[i++];
+    }
+    if (i >= in_len) {
+      return 0;
+    }
+    size_t back = ((ctrl & 0x1f) << 8) + ip[i++] + 1;
+    len += 2;
+    if (back > o || o + len > out_len) {
+      return 0;
+    }
+    // the source may overlap the destination, copy byte by byte
+    for (size_t j = 0; j < len; j++, o++) {
+      op[o] = op[o - back];
+    }
+  }
+  return o;
+}
+
+}  // namespace lzf
@@ -0,0 +1,30 @@
+/*
+ * Minimal LZ77 codec producing the LZF stream format of liblzf (Marc Lehmann). Streams written by lzf::Compress can
+ * be read by liblzf and vice versa.
+ *
+ * A stream is a sequence of:
+ *   000LLLLL <L+1 literal bytes>                       literal run of 1..32 bytes
+ *   LLLooooo oooooooo                                  back reference of L+2 bytes (L = 1..6)
+ *   111ooooo LLLLLLLL oooooooo                         back reference of L+9 bytes
+ * where the offset o + 1 is the distance back into the already decompressed output (at most 8192).
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace lzf {
+
+/**
+ * Compress `in_len` bytes into `out`.
+ * @return the compressed size, or 0 if the result would not fit into `out_len` bytes
+ */
+auto Compress(const void *in, size_t in_len, void *out, size_t out_len) -> size_t;
+
+/**
+ * Decompress a stream of `in_len` bytes into `out`.
+ * @return the decompressed size, or 0 if the stream is corrupt or does not fit into `out_len` bytes
+ */
+auto Decompress(const void *in, size_t in_len, void *out, size_t out_len) -> size_t;
+
+}  // namespace lzf
@@ -29,15 +29,25 @@ auto ClockMs() -> uint64_t {
   return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
 }
 
-static const size_t BUSTUB_SCAN_THREAD = 8;
-static const size_t BUSTUB_GET_THREAD = 8;
 static const size_t LRU_K_SIZE = 16;
 static const size_t BUSTUB_PAGE_CNT = 6400;
 static const size_t BUSTUB_BPM_SIZE = 64;
 
+/** Number of pages the current thread has read from disk, i.e. its buffer pool misses. */
+static thread_local uint64_t thread_disk_reads = 0;
+
+class CountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    thread_disk_reads++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+};
+
 struct BpmTotalMetrics {
   uint64_t scan_cnt_{0};
   uint64_t get_cnt_{0};
+  uint64_t get_miss_cnt_{0};
   uint64_t start_time_{0};
   std::mutex mutex_;
 
@@ -48,9 +58,10 @@ struct BpmTotalMetrics {
     scan_cnt_ += scan_cnt;
   }
 
-  void ReportGet(uint64_t get_cnt) {
+  void ReportGet(uint64_t get_cnt, uint64_t get_miss_cnt) {
     std::unique_lock<std::mutex> l(mutex_);
     get_cnt_ += get_cnt;
+    get_miss_cnt_ += get_miss_cnt;
   }
 
   void Report() {
@@ -58,14 +69,38 @@ struct BpmTotalMetrics {
     auto elsped = now - start_time_;
     auto scan_per_sec = scan_cnt_ / static_cast<double>(elsped) * 1000;
     auto get_per_sec = get_cnt_ / static_cast<double>(elsped) * 1000;
+    auto get_hit_ratio = get_cnt_ == 0 ? 0 : 1 - get_miss_cnt_ / static_cast<double>(get_cnt_);
 
     fmt::print("<<< BEGIN\n");
     fmt::print("scan: {}\n", scan_per_sec);
     fmt::print("get: {}\n", get_per_sec);
+    fmt::print("get_hit_ratio: {}\n", get_hit_ratio);
     fmt::print(">>> END\n");
   }
 };
 
+auto HistogramJson(const bustub::LatencyHistogram &histogram) -> std::string {
+  std::string buckets;
+  for (size_t i = 0; i < bustub::LATENCY_HISTOGRAM_BUCKETS; i++) {
+    buckets += fmt::format("{}{}", i == 0 ? "" : ",", histogram.buckets_[i]);
+  }
+  return fmt::format(R"({{"count":{},"mean_us":{:.3f},"p50_us":{},"p99_us":{},"buckets":[{}]}})", histogram.Count(),
+                     histogram.Mean(), histogram.Percentile(0.5), histogram.Percentile(0.99), buckets);
+}
+
+/** Print the statistics of the buffer pool and the disk manager as a single line of JSON. */
+void DumpStatsJson(const bustub::BufferPoolStats &bpm, const bustub::DiskManagerStats &disk) {
+  fmt::print(R"({{"bpm":{{"hits":{},"misses":{},"evictions":{},"dirty_writebacks":{},"flusher_writes":{},)"
+             R"("io_waits":{},"no_free_frame":{},"new_pages":{},"prefetches":{},"miss_latency":{},)"
+             R"("io_wait_latency":{}}},"disk":{{"reads":{},"writes":{},"syncs":{},"read_latency":{},)"
+             R"("write_latency":{},"sync_latency":{}}}}})"
+             "\n",
+             bpm.hits_, bpm.misses_, bpm.evictions_, bpm.dirty_writebacks_, bpm.flusher_writes_, bpm.io_waits_,
+             bpm.no_free_frame_, bpm.new_pages_, bpm.prefetches_, HistogramJson(bpm.miss_latency_),
+             HistogramJson(bpm.io_wait_latency_), disk.reads_, disk.writes_, disk.syncs_,
+             HistogramJson(disk.read_latency_), HistogramJson(disk.write_latency_), HistogramJson(disk.sync_latency_));
+}
+
 struct BpmMetrics {
   uint64_t start_time_{0};
   uint64_t last_report_at_{0};
@@ -104,12 +139,29 @@ struct BpmMetrics {
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
-  using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-bpm-bench");
   program.add_argument("--duration").help("run bpm bench for n milliseconds");
   program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--partitions").help("split the buffer pool into n partitions");
+  program.add_argument("--scan-thread-n").help("run n scan threads, 0 measures point gets alone");
+  program.add_argument("--get-thread-n").help("run n zipfian point get threads");
+  program.add_argument("--replacer").help("replacement policy: lru_k (default), lru, clock, 2q or arc");
+  program.add_argument("--compressed-cache-pages")
+      .help("put a compressed page cache of n pages between the buffer pool and the disk, 0 (default) disables it");
+  program.add_argument("--background-flush")
+      .help("run the background flusher so that fetches rarely write back dirty victims")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--no-scan-hint")
+      .help("let scan threads fetch with AccessType::Unknown instead of AccessType::Scan")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--stats-json")
+      .help("print the buffer pool and disk statistics of the run as a line of JSON after the report")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -129,12 +181,52 @@ auto main(int argc, char **argv) -> int {
     latency_ms = std::stoi(program.get("--latency"));
   }
 
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  uint64_t partitions = 1;
+  if (program.present("--partitions")) {
+    partitions = std::stoi(program.get("--partitions"));
+  }
+
+  uint64_t scan_thread_n = 8;
+  if (program.present("--scan-thread-n")) {
+    scan_thread_n = std::stoi(program.get("--scan-thread-n"));
+  }
+
+  uint64_t get_thread_n = 8;
+  if (program.present("--get-thread-n")) {
+    get_thread_n = std::stoi(program.get("--get-thread-n"));
+  }
+
+  auto scan_access_type = program.get<bool>("--no-scan-hint") ? AccessType::Unknown : AccessType::Scan;
+
+  auto replacer_policy = bustub::ReplacerPolicy::LRUK;
+  if (program.present("--replacer")) {
+    auto policy = bustub::ReplacerPolicyFromString(program.get("--replacer"));
+    if (!policy.has_value()) {
+      std::cerr << "unknown replacer: " << program.get("--replacer") << std::endl;
+      return 1;
+    }
+    replacer_policy = *policy;
+  }
+
+  uint64_t compressed_cache_pages = 0;
+  if (program.present("--compressed-cache-pages")) {
+    compressed_cache_pages = std::stoi(program.get("--compressed-cache-pages"));
+  }
+  bustub::bpm_compressed_cache_size = compressed_cache_pages * bustub::BUSTUB_PAGE_SIZE;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr, partitions,
+                                                 replacer_policy);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_page={}, page_size={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}, "
+             "partitions={}, scan_thread_n={}, get_thread_n={}, scan_hint={}, replacer={}, background_flush={}, "
+             "compressed_cache_pages={}\n",
+             BUSTUB_PAGE_CNT, bustub::BUSTUB_PAGE_SIZE, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE,
+             partitions, scan_thread_n, get_thread_n, scan_access_type == AccessType::Scan,
+             bustub::ReplacerPolicyToString(replacer_policy), program.get<bool>("--background-flush"),
+             compressed_cache_pages);
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -152,6 +244,16 @@ auto main(int argc, char **argv) -> int {
   // enable disk latency after creating all pages
   disk_manager->SetLatency(latency_ms);
 
+  if (program.get<bool>("--background-flush")) {
+    bpm->StartBackgroundFlusher();
+  }
+
+  // 只统计benchmark阶段
+  bpm->ResetStats();
+  disk_manager->ResetStats();
+  if (auto *cache = bpm->GetCompressedCache(); cache != nullptr) {
+    cache->ResetStats();
+  }
   fmt::print(stderr, "[info] benchmark start\n");
 
   BpmTotalMetrics total_metrics;
@@ -159,15 +261,16 @@ auto main(int argc, char **argv) -> int {
 
   std::vector<std::thread> threads;
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+  for (size_t thread_id = 0; thread_id < scan_thread_n; thread_id++) {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics, scan_thread_n,
+                                      scan_access_type] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
-      size_t page_idx = BUSTUB_PAGE_CNT * thread_id / BUSTUB_SCAN_THREAD;
+      size_t page_idx = BUSTUB_PAGE_CNT * thread_id / scan_thread_n;
 
       while (!metrics.ShouldFinish()) {
-        auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Scan);
+        auto *page = bpm->FetchPage(page_ids[page_idx], scan_access_type);
         if (page == nullptr) {
           continue;
         }
@@ -180,7 +283,7 @@ auto main(int argc, char **argv) -> int {
         }
         page->WUnlatch();
 
-        bpm->UnpinPage(page->GetPageId(), true, AccessType::Scan);
+        bpm->UnpinPage(page->GetPageId(), true, scan_access_type);
         page_idx = (page_idx + 1) % BUSTUB_PAGE_CNT;
         metrics.Tick();
         metrics.Report();
@@ -190,7 +293,7 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
+  for (size_t thread_id = 0; thread_id < get_thread_n; thread_id++) {
     threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
@@ -218,7 +321,7 @@ auto main(int argc, char **argv) -> int {
         metrics.Report();
       }
 
-      total_metrics.ReportGet(metrics.cnt_);
+      total_metrics.ReportGet(metrics.cnt_, thread_disk_reads);
     }));
   }
 
@@ -227,6 +330,14 @@ auto main(int argc, char **argv) -> int {
   }
 
   total_metrics.Report();
+  if (auto *cache = bpm->GetCompressedCache(); cache != nullptr) {
+    auto stats = cache->GetStats();
+    fmt::print(stderr, "[info] compressed_cache hit_rate={:.3f}, compression_ratio={:.2f}, writebacks={}\n",
+               stats.HitRate(), stats.CompressionRatio(), stats.writebacks_);
+  }
+  if (program.get<bool>("--stats-json")) {
+    DumpStatsJson(bpm->GetStats(), disk_manager->GetStats());
+  }
 
   return 0;
 }
@@ -113,12 +113,21 @@ auto KeyWillChange(size_t key) -> bool { return key % 5 == 0; }
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
+  using bustub::BUSTUB_PAGE_SIZE;
   using bustub::BufferPoolManager;
   using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--optimistic")
+      .help("look up keys without page latches, validating page versions instead")
+      .default_value(false)
+      .implicit_value(true);
+  program.add_argument("--blink")
+      .help("insert and remove with the B-link protocol instead of latch crabbing")
+      .default_value(false)
+      .implicit_value(true);
 
   try {
     program.parse_args(argc, argv);
@@ -133,11 +142,17 @@ auto main(int argc, char **argv) -> int {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
+  bool optimistic = program.get<bool>("--optimistic");
+  auto protocol = program.get<bool>("--blink") ? bustub::BPlusTreeProtocol::BLink : bustub::BPlusTreeProtocol::LatchCrabbing;
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr,
+             "[info] total_keys={}, page_size={}, duration_ms={}, lru_k_size={}, bpm_size={}, optimistic={}, "
+             "blink={}\n",
+             TOTAL_KEYS, bustub::BUSTUB_PAGE_SIZE, duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE, optimistic,
+             protocol == bustub::BPlusTreeProtocol::BLink);
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -145,8 +160,12 @@ auto main(int argc, char **argv) -> int {
   page_id_t page_id;
   auto header_page = bpm->NewPageGuarded(&page_id);
 
-  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
-                                                                                            bpm.get(), comparator);
+  // LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are defined in terms of KeyType and ValueType
+  using KeyType = bustub::GenericKey<8>;
+  using ValueType = bustub::RID;
+  bustub::BPlusTree<KeyType, ValueType, bustub::GenericComparator<8>> index(
+      "foo_pk", page_id, bpm.get(), comparator, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE, protocol);
+  index.SetOptimisticReads(optimistic);
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
     bustub::GenericKey<8> index_key;
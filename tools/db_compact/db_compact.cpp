@@ -0,0 +1,47 @@
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "argparse/argparse.hpp"
+#include "common/exception.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-db-compact");
+  program.add_argument("db_file").help("the db file to compact, must not be in use by a running instance");
+  program.add_argument("--dry-run")
+      .help("only report the free pages, do not truncate the file")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto db_file = program.get<std::string>("db_file");
+  if (!std::filesystem::exists(db_file)) {
+    std::cerr << db_file << " does not exist" << std::endl;
+    return 1;
+  }
+  try {
+    bustub::DiskManager disk_manager(db_file);
+    size_t num_pages = disk_manager.GetNumPages();
+    size_t num_free_pages = disk_manager.GetNumFreePages();
+    fmt::print("{}: {} pages, {} free\n", db_file, num_pages, num_free_pages);
+    if (!program.get<bool>("--dry-run")) {
+      size_t truncated = disk_manager.TruncateFreeTail();
+      fmt::print("truncated {} free pages from the end, {} pages left\n", truncated, disk_manager.GetNumPages());
+    }
+    disk_manager.ShutDown();
+  } catch (const bustub::Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}